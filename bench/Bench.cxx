@@ -0,0 +1,341 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bench.H"
+
+namespace
+{
+  const char *usage =
+    "usage: %s [--json FILE] [--filter TEXT] [--quick]\n";
+
+  // each result is the median of this many rounds
+  const int rounds = 7;
+
+  struct result
+  {
+    std::string name;
+    double ns_per_op;
+    double mb_per_s;
+    long ops;
+  };
+
+  struct named_value
+  {
+    std::string name;
+    double value;
+    std::string unit;
+  };
+
+  struct named_check
+  {
+    std::string name;
+    bool ok;
+  };
+
+  std::vector<result> results;
+  std::vector<named_value> values;
+  std::vector<named_check> checks;
+
+  const char *json_path = 0;
+  const char *filter = 0;
+  double round_time = 0.05;
+
+  const char *nicks[] =
+  {
+    "joe", "alice", "bob", "carol", "dave", "eve", "mallory", "trent",
+    "peggy", "victor", "walter", "zoe"
+  };
+
+  const char *words[] =
+  {
+    "the", "server", "is", "slow", "again", "anyone", "seen", "this",
+    "lol", "brb", "ok", "what", "about", "tonight", "patch", "works",
+    "for", "me", "no", "idea", "why", "it", "broke", "café", "naïve"
+  };
+
+  template <typename T, int N>
+  const T &pick(std::minstd_rand &random, T (&list)[N])
+  {
+    return list[random() % N];
+  }
+
+  std::string sentence(std::minstd_rand &random)
+  {
+    std::string text;
+    const int count = 3 + random() % 12;
+
+    for (int i = 0; i < count; i++)
+    {
+      if (i > 0)
+        text += ' ';
+
+      text += pick(random, words);
+    }
+
+    return text;
+  }
+
+  std::string url(std::minstd_rand &random)
+  {
+    return "https://example.com/" + std::to_string(random() % 100000) +
+           "?q=" + pick(random, words);
+  }
+
+  void put_string(FILE *out, const std::string &text)
+  {
+    fputc('"', out);
+
+    for (const char c : text)
+    {
+      if (c == '"' || c == '\\')
+        fputc('\\', out);
+
+      fputc(c, out);
+    }
+
+    fputc('"', out);
+  }
+}
+
+// false if the arguments make no sense
+bool Bench::init(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+    {
+      json_path = argv[++i];
+    }
+    else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+    {
+      filter = argv[++i];
+    }
+    else if (strcmp(argv[i], "--quick") == 0)
+    {
+      round_time = 0.005;
+    }
+      else
+    {
+      fprintf(stderr, usage, argv[0]);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// body does ops operations on bytes bytes each time it is called,
+// it is repeated until a round takes long enough to time
+void Bench::run(const char *name, const long ops, const long bytes,
+                const std::function<void()> &body)
+{
+  typedef std::chrono::steady_clock clock;
+
+  if (filter != 0 && strstr(name, filter) == 0)
+    return;
+
+  body();
+
+  long repeat = 1;
+  std::vector<double> times;
+
+  while (true)
+  {
+    const clock::time_point start = clock::now();
+
+    for (long i = 0; i < repeat; i++)
+      body();
+
+    const std::chrono::duration<double> elapsed = clock::now() - start;
+
+    if (elapsed.count() >= round_time)
+      break;
+
+    repeat *= 2;
+  }
+
+  for (int i = 0; i < rounds; i++)
+  {
+    const clock::time_point start = clock::now();
+
+    for (long j = 0; j < repeat; j++)
+      body();
+
+    const std::chrono::duration<double> elapsed = clock::now() - start;
+
+    times.push_back(elapsed.count() / repeat);
+  }
+
+  std::sort(times.begin(), times.end());
+
+  const double seconds = times[rounds / 2];
+  const double ns_per_op = seconds * 1e9 / ops;
+  const double mb_per_s = bytes > 0 ? bytes / seconds / 1e6 : 0;
+
+  if (bytes > 0)
+    printf("%-40s %12.1f ns/op %10.1f MB/s\n", name, ns_per_op, mb_per_s);
+  else
+    printf("%-40s %12.1f ns/op\n", name, ns_per_op);
+
+  fflush(stdout);
+  results.push_back({ name, ns_per_op, mb_per_s, ops });
+}
+
+// something measured once, like memory held
+void Bench::value(const char *name, const double value, const char *unit)
+{
+  if (filter != 0 && strstr(name, filter) == 0)
+    return;
+
+  printf("%-40s %12.1f %s\n", name, value, unit);
+  values.push_back({ name, value, unit });
+}
+
+// a result that has to be right before its speed means anything
+void Bench::check(const char *name, const bool ok)
+{
+  printf("%-40s %s\n", name, ok ? "ok" : "FAILED");
+
+  checks.push_back({ name, ok });
+}
+
+// writes the JSON file if asked for, 1 if any check failed
+int Bench::finish()
+{
+  int failed = 0;
+
+  for (const named_check &c : checks)
+  {
+    if (c.ok == false)
+      failed++;
+  }
+
+  if (json_path != 0)
+  {
+    FILE *out = fopen(json_path, "w");
+
+    if (out == 0)
+    {
+      perror(json_path);
+      return 1;
+    }
+
+    fprintf(out, "{\n  \"results\": [");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+      fprintf(out, "%s\n    { \"name\": ", i > 0 ? "," : "");
+      put_string(out, results[i].name);
+      fprintf(out, ", \"ns_per_op\": %.3f, \"mb_per_s\": %.3f, "
+                   "\"ops\": %ld }",
+              results[i].ns_per_op, results[i].mb_per_s, results[i].ops);
+    }
+
+    fprintf(out, "\n  ],\n  \"values\": [");
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      fprintf(out, "%s\n    { \"name\": ", i > 0 ? "," : "");
+      put_string(out, values[i].name);
+      fprintf(out, ", \"value\": %.3f, \"unit\": ", values[i].value);
+      put_string(out, values[i].unit);
+      fprintf(out, " }");
+    }
+
+    fprintf(out, "\n  ],\n  \"checks\": [");
+
+    for (size_t i = 0; i < checks.size(); i++)
+    {
+      fprintf(out, "%s\n    { \"name\": ", i > 0 ? "," : "");
+      put_string(out, checks[i].name);
+      fprintf(out, ", \"ok\": %s }", checks[i].ok ? "true" : "false");
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+    fclose(out);
+  }
+
+  if (failed > 0)
+    printf("%d checks failed\n", failed);
+
+  return failed > 0 ? 1 : 0;
+}
+
+// server traffic with the usual mix of chat, joins, leaves, links and
+// private messages, the same every time
+std::string Bench::corpus(const int lines)
+{
+  std::minstd_rand random(1);
+  std::string text;
+
+  for (int i = 0; i < lines; i++)
+  {
+    const int kind = random() % 100;
+    const char *nick = pick(random, nicks);
+
+    if (kind < 55)
+      text += std::string("[") + nick + "]: " + sentence(random);
+    else if (kind < 65)
+      text += std::string("[") + nick + "]: " + sentence(random) + " " + url(random);
+    else if (kind < 70)
+      text += std::string("<") + nick + ": " + sentence(random);
+    else if (kind < 80)
+      text += "+[" + std::to_string(random() % 5000) + "]" + nick;
+    else if (kind < 88)
+      text += "-[" + std::to_string(random() % 5000) + "]";
+    else if (kind < 90)
+      text += std::string("(") + nick + " has connected using JoeClient)";
+    else
+      text += ">> " + sentence(random);
+
+    text += "\r\n";
+  }
+
+  return text;
+}
+
+// chat lines with one to three links each
+std::string Bench::urlCorpus(const int lines)
+{
+  std::minstd_rand random(2);
+  std::string text;
+
+  for (int i = 0; i < lines; i++)
+  {
+    text += std::string("[") + pick(random, nicks) + "]: ";
+
+    const int count = 1 + random() % 3;
+
+    for (int j = 0; j < count; j++)
+      text += sentence(random) + " " + url(random) + " ";
+
+    text += "\r\n";
+  }
+
+  return text;
+}
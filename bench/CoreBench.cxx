@@ -0,0 +1,717 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+// benchmarks for the parts of the client that don't need a display
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "Bench.H"
+#include "EventLoop.H"
+#include "Events.H"
+#include "Highlight.H"
+#include "LineBuffer.H"
+#include "Parser.H"
+#include "PollLoop.H"
+#include "Scan.H"
+#include "Session.H"
+#include "UserTable.H"
+
+namespace
+{
+  const int corpus_lines = 10000;
+
+  // the largest read, a full size TCP segment
+  const int segment = 1448;
+
+  const int group_size = 20;
+
+  PollLoop loop;
+
+  std::vector<std::string> split_lines(const std::string &text)
+  {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    size_t end;
+
+    while ((end = text.find('\n', start)) != std::string::npos)
+    {
+      lines.push_back(text.substr(start, end - start - 1));
+      start = end + 1;
+    }
+
+    return lines;
+  }
+
+  // every length up to three AVX2 blocks at every alignment, with what
+  // is looked for at each position including the last byte, on ascii
+  // and on utf-8, the bytes past the end would match if a kernel read
+  // them
+  bool edge_checks(const int k)
+  {
+    const char *backgrounds[] = { "ab", "\xc3\xa9" };
+    char buf[160];
+
+    for (const char *background : backgrounds)
+    {
+      for (int offset = 0; offset < 32; offset++)
+      {
+        for (int length = 0; length <= 97; length++)
+        {
+          for (int at = -1; at < length; at++)
+          {
+            for (int i = 0; i < offset + length; i++)
+              buf[i] = background[i % 2];
+
+            memcpy(buf + offset + length, "\nhttp\xff\n", 7);
+
+            char *text = buf + offset;
+
+            // the whole word where it fits, cut off where it doesn't
+            if (at >= 0)
+              memcpy(text + at, "http", std::min(4, length - at));
+
+            // a lone high byte among ascii, or ascii among utf-8
+            if (at >= 0 && length - at > 4)
+              text[at + 4] = background[0] == 'a' ? '\x80' : 'a';
+
+            Scan::setKernel(k);
+
+            const int byte = Scan::findByte(text, length, '\n', 'h');
+            const int word = Scan::find(text, length, "http", 4);
+            const int ascii = Scan::asciiRun(text, length);
+
+            Scan::setKernel(Scan::KERNEL_SCALAR);
+
+            if (byte != Scan::findByte(text, length, '\n', 'h') ||
+                word != Scan::find(text, length, "http", 4) ||
+                ascii != Scan::asciiRun(text, length) ||
+                byte != at || word != (length - at >= 4 ? at : -1))
+            {
+              return false;
+            }
+          }
+        }
+      }
+    }
+
+    return true;
+  }
+
+  // every kernel the cpu has against the scalar one, on random bytes
+  // at every alignment
+  void scan_checks()
+  {
+    const int saved = Scan::kernel();
+    std::minstd_rand random(3);
+    char buf[400];
+
+    for (int k = Scan::KERNEL_SSE2; k <= Scan::KERNEL_AVX2; k++)
+    {
+      if (Scan::setKernel(k) == false)
+        continue;
+
+      const std::string name = std::string("scan/") + Scan::kernelName();
+      bool ok = true;
+
+      for (int trial = 0; trial < 20000 && ok == true; trial++)
+      {
+        const int offset = random() % 64;
+        const int length = random() % (sizeof(buf) - 64);
+
+        // a small alphabet so the things looked for turn up
+        for (int i = 0; i < offset + length; i++)
+          buf[i] = "htp:/ \n\r\xc3\xa9"[random() % 10];
+
+        const char *text = buf + offset;
+
+        Scan::setKernel(k);
+
+        const int byte = Scan::findByte(text, length, '\n', '\r');
+        const int word = Scan::find(text, length, "http", 4);
+        const int ascii = Scan::asciiRun(text, length);
+
+        Scan::setKernel(Scan::KERNEL_SCALAR);
+
+        ok = byte == Scan::findByte(text, length, '\n', '\r') &&
+             word == Scan::find(text, length, "http", 4) &&
+             ascii == Scan::asciiRun(text, length);
+      }
+
+      Bench::check((name + " matches scalar").c_str(), ok);
+      Bench::check((name + " block edges").c_str(), edge_checks(k));
+    }
+
+    Scan::setKernel(saved);
+  }
+
+  // CRLF endings split between reads leave no CR on the nick
+  void crlf_checks()
+  {
+    const char text[] = "+[1]joe\r\n+[2]joanna\r\n";
+    const char *nicks[] = { "joe", "joanna" };
+    Event events[Parser::MAX_EVENTS];
+    LineBuffer buffer;
+    char *line;
+    int length = 0;
+
+    buffer.append(text, 8);
+
+    bool ok = buffer.nextLine(&length) == 0;
+
+    buffer.append(text + 8, sizeof(text) - 9);
+
+    for (const char *nick : nicks)
+    {
+      line = buffer.nextLine(&length);
+
+      ok = ok && line != 0 && Parser::scan(line, length, events) == 1 &&
+           events[0].type == Event::JOIN &&
+           events[0].nick.length == (int)strlen(nick) &&
+           memcmp(line + events[0].nick.start, nick, strlen(nick)) == 0;
+    }
+
+    Bench::check("linebuffer/crlf", ok);
+  }
+
+  // users keep renaming until their old names fill the pool several
+  // times over, each lookup by name has to land on the right line
+  // after the compactions that follow
+  void user_table_checks()
+  {
+    const int lines = 1000;
+    const int rounds = 50;
+    UserTable table;
+    std::string name;
+    bool ok = true;
+
+    for (int round = 0; round < rounds; round++)
+    {
+      for (int line = 0; line < lines; line++)
+      {
+        name = "user" + std::to_string(round) + "_" + std::to_string(line);
+        table.setName(line, name.c_str());
+      }
+
+      // every other user leaves before the next round
+      for (int line = 1; line < lines; line += 2)
+        table.deactivate(line);
+    }
+
+    // one more user renames often enough to force compactions that
+    // nobody else's rename follows
+    for (int i = 0; i < lines * 10; i++)
+    {
+      name = "renamed" + std::to_string(i);
+      table.setName(lines, name.c_str());
+    }
+
+    ok = ok && table.findName(name.c_str()) == lines;
+
+    for (int line = 0; line < lines; line++)
+    {
+      name = "user" + std::to_string(rounds - 1) + "_" + std::to_string(line);
+      ok = ok && table.findName(name.c_str()) == (line % 2 == 0 ? line : -1);
+      name = "user0_" + std::to_string(line);
+      ok = ok && table.findName(name.c_str()) == -1;
+    }
+
+    Bench::check("usertable/find_name", ok);
+  }
+
+  // whole buffers with nothing to find, the longest each search goes
+  void scan_benches()
+  {
+    const int saved = Scan::kernel();
+    std::string text(65536, 'a');
+
+    for (int k = Scan::KERNEL_SCALAR; k <= Scan::KERNEL_AVX2; k++)
+    {
+      if (Scan::setKernel(k) == false)
+        continue;
+
+      const std::string name = std::string("scan/") + Scan::kernelName();
+      volatile int sink;
+
+      Bench::run((name + "/find_byte").c_str(), 1, text.size(), [&]()
+      {
+        sink = Scan::findByte(text.data(), text.size(), '\n', '\r');
+      });
+
+      Bench::run((name + "/find").c_str(), 1, text.size(), [&]()
+      {
+        sink = Scan::find(text.data(), text.size(), "http", 4);
+      });
+
+      Bench::run((name + "/ascii_run").c_str(), 1, text.size(), [&]()
+      {
+        sink = Scan::asciiRun(text.data(), text.size());
+      });
+
+      (void)sink;
+    }
+
+    Scan::setKernel(saved);
+  }
+
+  // lines put back together from reads of random size, a quarter of
+  // them only a few bytes so lines and CRLFs are split anywhere
+  void reassemble_bench(const std::string &text, const int lines)
+  {
+    std::minstd_rand random(2);
+    std::vector<int> reads;
+    LineBuffer buffer;
+    int found = 0;
+
+    for (size_t i = 0; i < text.size(); i += reads.back())
+    {
+      const int size = random() % 4 == 0 ? 1 + random() % 4 :
+                                           1 + random() % segment;
+
+      reads.push_back(std::min((size_t)size, text.size() - i));
+    }
+
+    Bench::run("linebuffer/reassemble", lines, text.size(), [&]()
+    {
+      const char *data = text.data();
+      char *line;
+      int length;
+
+      found = 0;
+
+      for (const int size : reads)
+      {
+        buffer.append(data, size);
+        data += size;
+
+        while ((line = buffer.nextLine(&length)) != 0)
+          found++;
+      }
+    });
+
+    Bench::check("linebuffer/reassemble lines", found == lines);
+  }
+
+  void parser_bench(const char *name, const std::string &text)
+  {
+    std::vector<std::string> lines = split_lines(text);
+    Event events[Parser::MAX_EVENTS];
+    volatile int sink = 0;
+
+    Bench::run(name, lines.size(), text.size(), [&]()
+    {
+      for (const std::string &line : lines)
+        sink = sink + Parser::scan(line.data(), line.size(), events);
+    });
+  }
+
+  void highlight_bench(const std::string &text)
+  {
+    std::vector<std::string> lines = split_lines(text);
+    Event::Span marks[Highlight::MAX_MARKS];
+    Highlight highlight;
+    volatile int sink = 0;
+
+    highlight.setNick("joe");
+    highlight.setKeywords("server, patch, tonight, broke, release, "
+                          "crash, deploy, joeclient, outage, lag, "
+                          "review, merge, build, test, ping, pager, "
+                          "urgent, help, bug, fix");
+
+    Bench::run("highlight/find", lines.size(), text.size(), [&]()
+    {
+      for (const std::string &line : lines)
+      {
+        sink = sink + highlight.find(line.data(), line.size(), marks,
+                                     Highlight::MAX_MARKS);
+      }
+    });
+  }
+
+  // how a line was handled before it was parsed in place: strstr for a
+  // link, every byte checked against each character that ends one, the
+  // link copied out, then the text and its newline appended separately,
+  // sink stands in for the panes
+  void baseline_line(char *current, std::vector<char> *url_buf,
+                     size_t *sink)
+  {
+    size_t i = 0;
+    size_t j = 0;
+    bool write_line = current[0] != '@';
+
+    if ((current[0] == '+' || current[0] == '-') && current[1] == '[')
+    {
+      for (i = 2; i < 10 && current[i] != '\0'; i++)
+      {
+        if (current[i] == ']')
+        {
+          write_line = false;
+          break;
+        }
+      }
+    }
+
+    if (current[0] == '<')
+      *sink += strlen(current);
+
+    char *url_start = 0;
+    const char non_url_chars[] = "\r\n \"<>{}|\\^`";
+
+    if ((url_start = strstr(current, "http://")) != 0 ||
+        (url_start = strstr(current, "https://")) != 0)
+    {
+      for (j = 0; j < strlen(current); j++)
+      {
+        for (i = 0; i < strlen(non_url_chars); i++)
+        {
+          if (current[j] == non_url_chars[i])
+          {
+            current[j] = ' ';
+            break;
+          }
+        }
+      }
+
+      const int length = current + j - url_start;
+
+      url_buf->resize(length + 1);
+      snprintf(url_buf->data(), length + 1, "%s", url_start);
+
+      for (j = 0; j < (size_t)length; j++)
+      {
+        if ((*url_buf)[j] == ' ')
+        {
+          (*url_buf)[j] = '\0';
+          break;
+        }
+      }
+
+      *sink += strlen(url_buf->data());
+    }
+
+    if (write_line == true)
+      *sink += strlen(current) + strlen("\n");
+  }
+
+  // from received bytes to dispatched events, with the user table,
+  // nick index and link events behind it but nothing drawn
+  void handle_msg_bench(const char *name, const std::string &text,
+                        const int lines)
+  {
+    Session session;
+
+    Bench::run(name, lines, text.size(), [&]()
+    {
+      for (size_t i = 0; i < text.size(); i += 16384)
+      {
+        const int size = text.size() - i < 16384 ? text.size() - i : 16384;
+
+        session.feed(text.data() + i, size);
+      }
+    });
+  }
+
+  // the same bytes through the old line handling
+  void baseline_bench(const char *name, const std::string &text,
+                      const int lines)
+  {
+    LineBuffer buffer;
+    std::vector<char> url_buf;
+    volatile size_t sink = 0;
+
+    Bench::run(name, lines, text.size(), [&]()
+    {
+      size_t appended = 0;
+
+      for (size_t i = 0; i < text.size(); i += 16384)
+      {
+        const int size = text.size() - i < 16384 ? text.size() - i : 16384;
+        char *line;
+        int length;
+
+        buffer.append(text.data() + i, size);
+
+        while ((line = buffer.nextLine(&length)) != 0)
+        {
+          if (length > 0)
+            baseline_line(line, &url_buf, &appended);
+        }
+      }
+
+      sink = appended;
+    });
+
+    (void)sink;
+  }
+
+  // user lists and what a session costs to keep around
+  void session_benches()
+  {
+    // every user joins, then every user leaves
+    const int users = 10000;
+    std::string joins;
+    std::string leaves;
+
+    for (int i = 0; i < users; i++)
+    {
+      joins += "+[" + std::to_string(i) + "]user" + std::to_string(i) + "\n";
+      leaves += "-[" + std::to_string(i) + "]\n";
+    }
+
+    // each feed is followed by the loop pass that brings the user pane
+    // up to date, inserting every row and then erasing it
+    Session churn;
+    bool shown = true;
+
+    Bench::run("session/user_churn", users * 2,
+               joins.size() + leaves.size(), [&]()
+    {
+      churn.feed(joins.data(), joins.size());
+      loop.wait(0);
+      shown = shown && churn.userCount() == users;
+      churn.feed(leaves.data(), leaves.size());
+      loop.wait(0);
+      shown = shown && churn.userCount() == 0;
+    });
+
+    Bench::check("session/user_churn pane", shown);
+
+    Session empty;
+    Session full;
+
+    full.feed(joins.data(), joins.size());
+    loop.wait(0);
+
+    Bench::value("memory/session_empty", empty.memoryUsed(), "bytes");
+    Bench::value("memory/session_10000_users", full.memoryUsed(), "bytes");
+    Bench::value("memory/per_user",
+                 (double)(full.memoryUsed() - empty.memoryUsed()) / users,
+                 "bytes");
+  }
+
+  // the server end of each session in the group
+  struct peer
+  {
+    int fd;
+    size_t sent;
+  };
+
+  std::vector<peer> peers;
+  const std::string *payload = 0;
+
+  void peer_writable(int fd, void *data)
+  {
+    peer *p = &peers[(long)data];
+    const int size = send(fd, payload->data() + p->sent,
+                          payload->size() - p->sent, 0);
+
+    if (size > 0)
+      p->sent += size;
+
+    if (p->sent >= payload->size())
+      EventLoop::removeFd(fd, EventLoop::WRITE);
+  }
+
+  void accept_ready(int fd, void *)
+  {
+    const int client = accept(fd, 0, 0);
+
+    if (client >= 0)
+    {
+      fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) | O_NONBLOCK);
+      peers.push_back({ client, 0 });
+    }
+  }
+
+  int listen_local(int *port)
+  {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    socklen_t size = sizeof(addr);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(fd, group_size) != 0 ||
+        getsockname(fd, (struct sockaddr *)&addr, &size) != 0)
+    {
+      return -1;
+    }
+
+    *port = ntohs(addr.sin_port);
+
+    return fd;
+  }
+
+  double cpu_seconds()
+  {
+    return (double)clock() / CLOCKS_PER_SEC;
+  }
+
+  // a group of sessions connected over loopback on the poll() loop,
+  // what they cost sitting idle and taking traffic
+  void group_bench(const std::string &text, const int lines)
+  {
+    int port;
+    const int listen_fd = listen_local(&port);
+
+    if (listen_fd < 0)
+    {
+      Bench::check("sessions/listen", false);
+      return;
+    }
+
+    EventLoop::addFd(listen_fd, EventLoop::READ, accept_ready, 0);
+
+    std::vector<Session *> sessions;
+
+    for (int i = 0; i < group_size; i++)
+    {
+      sessions.push_back(new Session());
+      sessions.back()->connect("127.0.0.1", port, false, false, false);
+    }
+
+    for (int i = 0; i < 100 && (int)peers.size() < group_size; i++)
+      loop.wait(0.05);
+
+    bool connected = (int)peers.size() == group_size;
+
+    for (Session *session : sessions)
+    {
+      while (session->isConnecting() == true)
+        loop.wait(0.05);
+
+      connected = connected && session->isConnected();
+    }
+
+    Bench::check("sessions/connect", connected);
+
+    if (connected == true)
+    {
+      const double idle_start = cpu_seconds();
+
+      for (int i = 0; i < 20; i++)
+        loop.wait(0.05);
+
+      Bench::value("sessions/idle_cpu", (cpu_seconds() - idle_start) * 100,
+                   "% of a core");
+
+      size_t memory = 0;
+
+      for (Session *session : sessions)
+        memory += session->memoryUsed();
+
+      Bench::value("sessions/idle_memory", memory / group_size, "bytes each");
+
+      unsigned long target = 0;
+
+      payload = &text;
+
+      Bench::run("sessions/busy", lines * group_size,
+                 text.size() * group_size, [&]()
+      {
+        target += text.size();
+
+        for (size_t i = 0; i < peers.size(); i++)
+        {
+          peers[i].sent = 0;
+          EventLoop::addFd(peers[i].fd, EventLoop::WRITE, peer_writable,
+                           (void *)(long)i);
+        }
+
+        bool done = false;
+
+        while (done == false)
+        {
+          loop.wait(1.0);
+          done = true;
+
+          for (Session *session : sessions)
+            done = done && session->readStats()->bytes >= target;
+        }
+      });
+
+      memory = 0;
+
+      for (Session *session : sessions)
+        memory += session->memoryUsed();
+
+      Bench::value("sessions/busy_memory", memory / group_size, "bytes each");
+    }
+
+    for (Session *session : sessions)
+      delete session;
+
+    for (const peer &p : peers)
+    {
+      EventLoop::removeFd(p.fd);
+      close(p.fd);
+    }
+
+    peers.clear();
+    EventLoop::removeFd(listen_fd);
+    close(listen_fd);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (Bench::init(argc, argv) == false)
+    return 2;
+
+  signal(SIGPIPE, SIG_IGN);
+  EventLoop::use(&loop);
+
+  const std::string text = Bench::corpus(corpus_lines);
+  const std::string urls = Bench::urlCorpus(corpus_lines);
+
+  printf("scan kernel %s, %d line corpus of %d bytes\n",
+         Scan::kernelName(), corpus_lines, (int)text.size());
+
+  scan_checks();
+  crlf_checks();
+  user_table_checks();
+  scan_benches();
+  reassemble_bench(text, corpus_lines);
+  parser_bench("parser/scan", text);
+  parser_bench("parser/urls", urls);
+  highlight_bench(text);
+  handle_msg_bench("session/handle_msg", text, corpus_lines);
+  baseline_bench("session/handle_msg_baseline", text, corpus_lines);
+  handle_msg_bench("session/handle_msg_urls", urls, corpus_lines);
+  baseline_bench("session/handle_msg_urls_baseline", urls, corpus_lines);
+  session_benches();
+  group_bench(text, corpus_lines);
+
+  return Bench::finish();
+}
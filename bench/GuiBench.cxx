@@ -0,0 +1,209 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+// benchmarks for the panes, these need a display (make bench starts
+// them on Xvfb when there isn't one)
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <FL/Fl.H>
+#include <FL/Fl_Double_Window.H>
+
+#include "Bench.H"
+#include "Chat.H"
+#include "Dialog.H"
+#include "EventLoop.H"
+#include "FltkLoop.H"
+#include "Gui.H"
+#include "Language.H"
+#include "Parser.H"
+#include "StyledText.H"
+#include "UrlSelect.H"
+
+namespace
+{
+  // what the server pane keeps, and how many links the link pane does
+  const int scrollback = 1000;
+  const int url_count = 100;
+
+  const int batch = 1000;
+
+  std::vector<std::string> split_lines(const std::string &text)
+  {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    size_t end;
+
+    while ((end = text.find('\n', start)) != std::string::npos)
+    {
+      // keep the newline, drop the carriage return
+      lines.push_back(text.substr(start, end - start - 1) + "\n");
+      start = end + 1;
+    }
+
+    return lines;
+  }
+
+  // lines styled the way the server pane styles them, with the pane
+  // already full so every line trims one off the top
+  void styled_text_benches(const std::vector<std::string> &lines)
+  {
+    Fl_Double_Window *window = new Fl_Double_Window(800, 400, "bench");
+    StyledText *pane = new StyledText(0, 0, 800, 400, scrollback);
+
+    window->end();
+    window->show();
+
+    std::vector<int> starts;
+    size_t bytes = 0;
+
+    for (const std::string &line : lines)
+    {
+      Event events[Parser::MAX_EVENTS];
+
+      Parser::scan(line.data(), line.size() - 1, events);
+      starts.push_back(events[0].message.start);
+    }
+
+    for (int i = 0; i < batch; i++)
+      bytes += lines[i].size();
+
+    size_t next = 0;
+
+    auto append = [&](const int count)
+    {
+      for (int i = 0; i < count; i++)
+      {
+        const std::string &line = lines[next];
+
+        pane->append(line.data(), line.size(), starts[next], 'C', 'A');
+        next = (next + 1) % lines.size();
+      }
+    };
+
+    append(scrollback);
+    Fl::flush();
+
+    Bench::run("styledtext/append_full", batch, bytes, [&]()
+    {
+      append(batch);
+    });
+
+    // what a busy server costs once the pane is drawn as well
+    Bench::run("styledtext/append_draw", 100, bytes / 10, [&]()
+    {
+      append(100);
+      Fl::flush();
+    });
+
+    Bench::run("styledtext/draw", 1, 0, [&]()
+    {
+      pane->redraw();
+      Fl::flush();
+    });
+
+    window->hide();
+    delete window;
+  }
+
+  // the pointer moving down a full link pane, each move finds the
+  // line under it
+  void url_select_benches(const std::vector<std::string> &urls)
+  {
+    Fl_Double_Window *window = new Fl_Double_Window(400, 144, "bench");
+    UrlSelect *select = new UrlSelect(0, 0, 400, 144, 0);
+
+    window->end();
+    window->show();
+
+    for (int i = 0; i < url_count; i++)
+      select->add(urls[i % urls.size()].c_str());
+
+    select->bottomline(select->size());
+    Fl::flush();
+
+    const int moves = select->h();
+
+    Bench::run("urlselect/hover", moves, 0, [&]()
+    {
+      for (int y = 0; y < moves; y++)
+      {
+        Fl::e_x = select->x() + 40;
+        Fl::e_y = select->y() + y;
+        select->handle(FL_MOVE);
+      }
+    });
+
+    Bench::run("urlselect/hover_draw", moves, 0, [&]()
+    {
+      for (int y = 0; y < moves; y++)
+      {
+        Fl::e_x = select->x() + 40;
+        Fl::e_y = select->y() + y;
+        select->handle(FL_MOVE);
+        Fl::flush();
+      }
+    });
+
+    window->hide();
+    delete window;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (Bench::init(argc, argv) == false)
+    return 2;
+
+  FltkLoop fltk_loop;
+
+  EventLoop::use(&fltk_loop);
+
+  Fl::visual(FL_DOUBLE | FL_RGB);
+
+  // the link pane asks the main window for its cursor
+  Language::set(Language::ENGLISH);
+  Dialog::init();
+  Gui::init();
+  Chat::init();
+  Gui::show();
+
+  const std::vector<std::string> lines = split_lines(Bench::corpus(10000));
+  std::vector<std::string> urls;
+
+  for (const std::string &line : split_lines(Bench::urlCorpus(url_count)))
+  {
+    Event events[Parser::MAX_EVENTS];
+    const int count = Parser::scan(line.data(), line.size() - 1, events);
+
+    for (int i = 1; i < count; i++)
+    {
+      urls.push_back(std::string(line.data() + events[i].message.start,
+                                 events[i].message.length));
+    }
+  }
+
+  styled_text_benches(lines);
+  url_select_benches(urls);
+
+  return Bench::finish();
+}
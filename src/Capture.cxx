@@ -0,0 +1,128 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Capture.H"
+
+namespace
+{
+  FILE *file = 0;
+
+  // whoever records, by stream number, gone sessions leave a hole so
+  // a new one at the same address gets a stream of its own
+  std::vector<const void *> streams;
+
+  std::chrono::steady_clock::time_point last_time;
+
+  void put_varint(unsigned long value)
+  {
+    while (value >= 0x80)
+    {
+      putc((value & 0x7f) | 0x80, file);
+      value >>= 7;
+    }
+
+    putc(value, file);
+  }
+
+  int stream_of(const void *owner)
+  {
+    std::vector<const void *>::iterator i =
+      std::find(streams.begin(), streams.end(), owner);
+
+    if (i != streams.end())
+      return i - streams.begin();
+
+    streams.push_back(owner);
+
+    return streams.size() - 1;
+  }
+}
+
+// false if the file can't be written, a capture already going is
+// finished first
+bool Capture::start(const char *path)
+{
+  stop();
+
+  file = fopen(path, "wb");
+
+  if (file == 0)
+    return false;
+
+  // a peak hour of traffic shouldn't wait on the disk for every read
+  setvbuf(file, 0, _IOFBF, 1 << 20);
+
+  fwrite("JCAP", 1, 4, file);
+  putc(VERSION, file);
+
+  streams.clear();
+  last_time = std::chrono::steady_clock::now();
+
+  return true;
+}
+
+void Capture::stop()
+{
+  if (file == 0)
+    return;
+
+  fclose(file);
+  file = 0;
+}
+
+bool Capture::active()
+{
+  return file != 0;
+}
+
+// data as it came off the socket (or out of OpenSSL), owner tells the
+// sessions apart
+void Capture::record(const void *owner, const char *data, const int size)
+{
+  if (file == 0 || size <= 0)
+    return;
+
+  const std::chrono::steady_clock::time_point now =
+    std::chrono::steady_clock::now();
+  const std::chrono::microseconds elapsed =
+    std::chrono::duration_cast<std::chrono::microseconds>(now - last_time);
+
+  // only whole microseconds are written, the rest carries over
+  last_time += elapsed;
+
+  put_varint(elapsed.count());
+  put_varint(stream_of(owner));
+  put_varint(size);
+  fwrite(data, 1, size, file);
+
+  // a full disk ends the capture, what made it to the file still replays
+  if (ferror(file))
+    stop();
+}
+
+void Capture::forget(const void *owner)
+{
+  std::replace(streams.begin(), streams.end(), owner, (const void *)0);
+}
@@ -18,513 +18,232 @@ along with JoeClient; if not, write to the Free Software
 Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
 */
 
-#include <array>
-#include <ctime>
-#include <cstdio>
-#include <cstdlib>
-#include <cstring>
-#include <openssl/ssl.h>
-
-#ifdef WIN32
-  #include <winsock2.h>
-  #include <ws2tcpip.h>
-#else
-  #include <unistd.h>
-  #include <string.h>
-  #include <arpa/inet.h>
-  #include <sys/socket.h>
-  #include <netdb.h>
-#endif
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #include <FL/Fl.H>
 
 #include "Chat.H"
 #include "Dialog.H"
-#include "Language.H"
 #include "Gui.H"
-
-#define MAX_USERS 256
+#include "Language.H"
+#include "Replay.H"
+#include "Session.H"
 
 namespace
 {
-#ifdef WIN32
-  WSADATA wsa_data;
-//  SOCKET sock;
-//
-//#else
-#endif
-  int sock;
-
-  struct sockaddr_in server;
-  struct addrinfo *ip_info;
-  struct addrinfo hints;
-
-  SSL_CTX *ctx = 0;
-  SSL *ssl = 0;
-
-  std::array<char, 4096> buf{};
-  std::array<char, 4096> ip_buf{};
-  std::array<char, 4096> url_buf{};
-  std::array<char, 4096> temp_buf{};
+  // one per server, each with its own tab
+  std::vector<Session *> sessions;
 
-  bool connected = false;
-  bool enable_ssl = false;
-  bool keep_alive = false;
+  // the session the panes, input and menu currently act on
+  Session *shown = 0;
 
-  time_t start_time, elapsed_time;
+  // preferences every session follows
+  bool threaded = false;
+  int probe_limit = 3;
+  int probe_interval = 120;
+  double send_rate = 2;
+  int send_burst = 5;
+  std::string keyword_list;
 
-  struct user_type
+  Session *add_session()
   {
-    std::array<char, 4096> name{};
-    bool active;
-  };
+    Session *session = new Session();
 
-  struct user_type user_list[MAX_USERS];
+    session->setThreaded(threaded);
+    session->setProbeLimit(probe_limit);
+    session->setProbeInterval(probe_interval);
+    session->sendQueue()->setRate(send_rate, send_burst);
+    session->highlight()->setKeywords(keyword_list.c_str());
+    sessions.push_back(session);
+    Gui::addSession(session);
 
-  void handle_msg(size_t size)
-  {
-    if (size > 0)
-    {
-      size_t i = 0, j = 0;
-
-      for (i = 0; i < size; i++)
-      {
-        if (temp_buf[i] != '\0')
-          buf[j++] = temp_buf[i];
-      }
-
-      buf[j] = '\0';
-
-      char *p = 0;
-      char *current = strtok_r(buf.data(), "\n", &p);
-
-      while (current != 0)
-      {
-        bool write_line = true;
-
-        // ignore @ reply from .Z
-        if (current[0] == '@')
-          write_line = false;
-
-        // check users
-        if ((current[0] == '+') && (current[1] == '['))
-        {
-          for (i = 2; i < 10; i++)
-          {
-            if (current[i] == ']')
-            {
-              current[i] = '\0';
-              Chat::addUser(atoi(current + 2), current + i + 1);
-              write_line = false;
-              break;
-            }
-          }
-        }
-
-        if ((current[0] == '-') && (current[1] == '['))
-        {
-          for (i = 2; i < 10; i++)
-          {
-            if (current[i] == ']')
-            {
-              current[i] = '\0';
-              Chat::removeUser(atoi(current + 2));
-              write_line = false;
-              break;
-            }
-          }
-        }
-
-        // check for private message
-        if (current[0] == '<')
-        {
-          // stop at first carriage return
-          for (i = 0; i < strlen(current); i++)
-          {
-            if (current[i] == '\n')
-            {
-              current[i] = '\0';
-              break;
-            }
-          }
-
-          Gui::appendPM(current);
-        }
-
-        // check for url
-        char *url_start = 0, *url_end = 0;
-        const char non_url_chars[] = "\r\n \"<>{}|\\^`";
-
-        if (((url_start = strstr(current, "http://")) != 0) ||
-           ((url_start = strstr(current, "https://")) != 0))
-        {
-          // stop at first non-url character
-          for (j = 0; j < strlen(current); j++)
-          {
-            for (i = 0; i < strlen(non_url_chars); i++)
-            {
-              if (current[j] == non_url_chars[i])
-              {
-                current[j] = ' ';
-                break;
-              }
-            }
-          }
-
-          url_end = &current[j];
-
-          const int length = url_end - url_start;
-          snprintf(url_buf.data(), length + 1, "%s", url_start);
-
-          for (j = 0; j < strlen(current); j++)
-          {
-            if (url_buf[j] == ' ')
-            {
-              url_buf[j] = '\0';
-              break;
-            }
-          }
-
-          Gui::appendURL(url_buf.data());
-        }
-
-        if (write_line == true)
-        {
-          Gui::append(current);
-          Gui::append("\n");
-        }
-
-        current = strtok_r(0, "\n", &p);
-
-        if (current == 0)
-          break;
-      }
-    }
-      else
-    {
-      Chat::disconnect("Disconnected", "Connection Closed");
-    }
+    return session;
   }
 
-  void chat_read(FL_SOCKET sockfd, void *)
+  // each stream in a capture gets a tab of its own
+  Session *replay_session(const int)
   {
-    buf.fill(0);
-    temp_buf.fill(0);
-    url_buf.fill(0);
+    Session *session = add_session();
+
+    Chat::select(session);
 
-    int size = recv(sockfd, temp_buf.data(), temp_buf.size(), 0);
-    handle_msg(size);
+    return session;
   }
 
-  void chat_read_ssl(FL_SOCKET, void *)
+  void replay_done(const char *summary)
   {
-    buf.fill(0);
-    temp_buf.fill(0);
-    url_buf.fill(0);
-
-    int size = SSL_read(ssl, temp_buf.data(), temp_buf.size());
-    handle_msg(size);
+    Dialog::message(Language::get(Language::REPLAY_FINISHED), summary);
   }
 }
 
-void Chat::connectToServer(const char *address, const int port,
-                           const bool enable_ssl_value,
-                           const bool keep_alive_value)
+void Chat::init()
 {
-  for (int i = 0; i < MAX_USERS; i++)
-    user_list[i].active = false;
-
-#ifdef WIN32
-  if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0)
-  {
-    Dialog::message("Error", "Could not initialize Winsock.");
-    return;
-  }
-#endif
-
-  hints.ai_family = AF_INET;
-  hints.ai_socktype = SOCK_STREAM;
-  hints.ai_protocol = IPPROTO_TCP;
+  select(add_session());
+}
 
-  if (getaddrinfo(address, 0, &hints, &ip_info) != 0)
-  {
-#ifdef WIN32
-    WSACleanup();
-    return;
-#endif
-    Dialog::message("Error", "Could not obtain IP address.");
-    return;
-  }
+// a session that is busy keeps its connection, the new one gets a tab
+// of its own, returns the session that connects
+Session *Chat::connectToServer(const char *address, const int port,
+                               const bool enable_ssl, const bool keep_alive,
+                               const bool auto_reconnect)
+{
+  if (shown->isConnected() == true || shown->isConnecting() == true)
+    select(add_session());
 
-  // convert host name to IP address
-  getnameinfo(ip_info->ai_addr, ip_info->ai_addrlen,
-              ip_buf.data(), ip_buf.size(), 0, 0, NI_NUMERICHOST);
+  shown->connect(address, port, enable_ssl, keep_alive, auto_reconnect);
 
-  server.sin_family = AF_INET;
-  server.sin_addr.s_addr = inet_addr(ip_buf.data());
-  server.sin_port = htons(port);
+  return shown;
+}
 
-  struct addrinfo *p;
+// the session may have been closed since its connect started
+void Chat::cancelConnect(Session *session)
+{
+  if (std::find(sessions.begin(), sessions.end(), session) != sessions.end())
+    session->cancelConnect();
+}
 
-  for (p = ip_info; p != NULL; p = p->ai_next)
-  {
-    sock = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
-
-    if (sock == -1)
-      continue;
-
-    if (connect(sock, (struct sockaddr *)&server,
-                sizeof(server)) == -1)
-    {
-#ifdef WIN32
-      closesocket(sock);
-#else
-      close(sock);
-#endif
-      sock = 0;
-      break;
-    }
-  }
+void Chat::userDisconnected()
+{
+  shown->userDisconnected();
+}
 
-  if (ip_info)
-    freeaddrinfo(ip_info);
+void Chat::disconnect(const char *title, const char *message)
+{
+  shown->disconnect(title, message);
+}
 
-  if (sock == 0)
-  {
-#ifdef WIN32
-    WSACleanup();
-    return;
-#endif
-    Dialog::message("Error", "Could not connect.");
-    return;
-  }
+void Chat::write(const char *message)
+{
+  shown->write(message);
+}
 
-// set non-blocking mode on Windows
-#ifdef WIN32
-  unsigned long int mode = 1;
+// typed or pasted text, let out a line at a time
+void Chat::send(const char *text)
+{
+  shown->sendQueue()->send(text);
+}
 
-  if (ioctlsocket(sock, FIONBIO, &mode) != NO_ERROR)
-  {
-    WSACleanup();
-    Dialog::message("Error", "Could not set socket to non-blocking mode.");
-    return;
-  }
-#endif
+void Chat::cancelSend()
+{
+  shown->sendQueue()->cancel();
+}
 
-  Gui::deactivateMenuItem(Language::get(Language::SERVER_CONNECT));
-  Gui::activateMenuItem(Language::get(Language::SERVER_DISCONNECT));
+// nicks starting with prefix, most recently active first
+int Chat::completeNick(const char *prefix, const int length,
+                       std::vector<std::string> *result)
+{
+  return shown->completeNick(prefix, length, result);
+}
 
-  connected = true;
-  enable_ssl = enable_ssl_value;
+// takes effect on the next connect
+void Chat::setThreaded(const bool value)
+{
+  threaded = value;
 
-  if (enable_ssl == true)
-  {
-    const SSL_METHOD *method = TLS_client_method();
-
-    SSL_CTX_free(ctx);
-    ctx = SSL_CTX_new(method);
-
-    if (ctx == NULL)
-    {
-      Chat::disconnect("Error", "SSL_CTX_new failed");
-      return;
-    }
-
-    SSL_free(ssl);
-    ssl = SSL_new(ctx);
-
-    if (ssl == NULL)
-    {
-      Chat::disconnect("Error", "SSL_new failed");
-      return;
-    }
-
-#ifdef WIN32
-    const int found_cert = SSL_CTX_load_verify_locations(ctx,
-                                                         "cacert.pem",
-                                                         NULL);
-    if (found_cert == 0)
-    {
-      Chat::disconnect("Error",
-                       "Could not load certificate file (cacert.pem).");
-      return;
-    }
-#endif
-
-    SSL_set_fd(ssl, sock);
-
-    int ssl_connect = 0;
-    int timeout = 10;
-
-    while (true)
-    {
-      ssl_connect = SSL_connect(ssl);
-
-      if (ssl_connect == 1)
-        break;
-
-#ifdef WIN32
-      Sleep(1000);
-#else
-      usleep(1000 * 1000);
-#endif
-
-      timeout--;
-
-      if (timeout == 0)
-      {
-        Chat::disconnect("Error", "Server does not support SSL.");
-        return;
-      }
-    }
-  }
+  for (Session *session : sessions)
+    session->setThreaded(value);
+}
 
-  keep_alive = keep_alive_value;
-  time(&start_time);
+bool Chat::isConnected()
+{
+  return shown->isConnected();
+}
 
-  // announcement
-  char connect_string[256];
+bool Chat::isConnecting()
+{
+  return shown->isConnecting();
+}
 
-  snprintf(connect_string, sizeof(connect_string),
-           "%% has connected using JoeClient");
+const Chat::ReadStats *Chat::readStats()
+{
+  return shown->readStats();
+}
 
-  Chat::write(connect_string);
+const Chat::ReconnectStats *Chat::reconnectStats()
+{
+  return shown->reconnectStats();
+}
 
-  // send .Z for user list
-  Chat::write(".Z");
+const Chat::LatencyStats *Chat::latencyStats()
+{
+  return shown->latencyStats();
+}
 
-  if (keep_alive_value)
-  {
-    Fl::add_timeout(120, Chat::keepAlive);
-  }
+// unanswered probes before the link counts as dead
+void Chat::setProbeLimit(const int limit)
+{
+  probe_limit = limit;
 
-  if (enable_ssl == true)
-  {
-    Fl::add_fd(sock, FL_READ, chat_read_ssl, NULL);
-  }
-    else
-  {
-    Fl::add_fd(sock, FL_READ, chat_read, NULL);
-  }
+  for (Session *session : sessions)
+    session->setProbeLimit(limit);
 }
 
-void Chat::userDisconnected()
+// seconds between keepalive probes
+void Chat::setProbeInterval(const int seconds)
 {
-  Chat::disconnect("Disconnected", "Connection Closed");
+  probe_interval = seconds;
+
+  for (Session *session : sessions)
+    session->setProbeInterval(seconds);
 }
 
-void Chat::disconnect(const char *title, const char *message)
+// lines per second and lines per burst, each session has its own bucket
+void Chat::setSendRate(const double rate, const int burst)
 {
-  if (connected == true)
-  {
-    Fl::remove_fd(sock);
-
-#ifdef WIN32
-    closesocket(sock);
-    WSACleanup();
-#else
-    close(sock);
-#endif
+  send_rate = rate;
+  send_burst = burst;
 
-    Gui::activateMenuItem(Language::get(Language::SERVER_CONNECT));
-    Gui::deactivateMenuItem(Language::get(Language::SERVER_DISCONNECT));
+  for (Session *session : sessions)
+    session->sendQueue()->setRate(rate, burst);
+}
 
-    connected = false;
-    Dialog::message(title, message);
-  }
+// words highlighted in every session, next to its own nick
+void Chat::setKeywords(const char *list)
+{
+  keyword_list = list;
 
-  Gui::append(">> JoeClient: Connection closed.");
+  for (Session *session : sessions)
+    session->highlight()->setKeywords(list);
 }
 
-void Chat::write(const char *message)
+const char *Chat::keywords()
 {
-  if (connected == true)
-  {
-    if (enable_ssl == true)
-    {
-      SSL_write(ssl, message, strlen(message));
-      SSL_write(ssl, "\n", 1);
-    }
-      else
-    {
-      struct timeval tv;
-      tv.tv_sec = 0;
-      tv.tv_usec = 100000;
-
-      fd_set fd;
-      FD_ZERO(&fd);
-
-      if (sock != 0)
-        FD_SET(sock, &fd);
-
-      select(sock + 1, 0, &fd, 0, &tv);
-
-      if (sock != 0 && FD_ISSET(sock, &fd))
-      {
-        send(sock, message, strlen(message), 0);
-        send(sock, "\n", 1, 0);
-      }
-    }
-  }
+  return keyword_list.c_str();
 }
 
-void Chat::keepAlive(void *data)
+Session *Chat::current()
 {
-  if (connected && keep_alive)
-  {
-    time(&elapsed_time);
-    double seconds = difftime(elapsed_time, start_time);
-
-    if (seconds > 120)
-    {
-      time(&start_time);
-      write("\n");
-    }
-  }
-
-  Fl::repeat_timeout(120, Chat::keepAlive, data);
+  return shown;
 }
 
-void Chat::addUser(int line, const char *name)
+void Chat::select(Session *session)
 {
-  if (line >= 0 && line < MAX_USERS)
-  {
-    snprintf(user_list[line].name.data(),
-             user_list[line].name.size(), "%s", name);
-    user_list[line].active = true;
-
-    Gui::clearUsers();
-
-    for (int i = 0; i < MAX_USERS; i++)
-    {
-      if (user_list[i].active == true)
-      {
-        Gui::appendUser(i, user_list[i].name.data());
-      }
-    }
-  }
+  shown = session;
+  Gui::showSession(session);
 }
 
-void Chat::removeUser(int line)
+// drop the shown session without asking, the last one is replaced by
+// a fresh one so there is always somewhere to connect from
+void Chat::closeSession()
 {
-  if (line >= 0 && line < MAX_USERS)
-  {
-    user_list[line].active = false;
+  Session *session = shown;
 
-    Gui::clearUsers();
+  Replay::drop(session);
+  Gui::removeSession(session);
+  sessions.erase(std::find(sessions.begin(), sessions.end(), session));
+  delete session;
 
-    for (int i = 0; i < MAX_USERS; i++)
-    {
-      if (user_list[i].active == true)
-      {
-        Gui::appendUser(i, user_list[i].name.data());
-      }
-    }
-  }
+  if (sessions.empty() == true)
+    add_session();
+
+  select(sessions.back());
 }
 
-bool Chat::isConnected()
+// feed a capture back through new sessions, speed 0 is as fast as
+// possible
+bool Chat::replay(const char *path, const double speed)
 {
-  return connected;
+  return Replay::start(path, speed, replay_session, replay_done);
 }
-
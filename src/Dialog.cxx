@@ -107,32 +107,56 @@ namespace Connect
     Fl_Int_Input *port;
     CheckBox *enable_ssl;
     CheckBox *keep_alive;
+    CheckBox *auto_reconnect;
+    Fl_Box *status;
     Fl_Button *ok;
     Fl_Button *cancel;
   }
 
+  // the session the dialog is waiting on, 0 until connectToServer
+  // returns it
+  Session *session = 0;
+
+  // a busy session is left alone, the connect opens another one
   void begin()
   {
-    if (Chat::isConnected() == true)
-      return;
-
     Items::ok->color(button_color);
     Items::ok->take_focus();
     Items::cancel->color(button_color);
     Items::dialog->show();
   }
 
+  // the dialog stays up until Chat reports back, so it can be cancelled
   void close()
   {
-    Items::dialog->hide();
-    Chat::connectToServer(Items::address->value(),
-                          atoi(Items::port->value()),
-                          Items::enable_ssl->value(),
-                          Items::keep_alive->value());
+    Items::ok->deactivate();
+    Items::status->copy_label(Language::get(Language::CONNECT_CONNECTING));
+    session = 0;
+    session = Chat::connectToServer(Items::address->value(),
+                                    atoi(Items::port->value()),
+                                    Items::enable_ssl->value(),
+                                    Items::keep_alive->value(),
+                                    Items::auto_reconnect->value());
   }
 
   void quit()
   {
+    // only cancel the connect this dialog started
+    if (Items::ok->active() == 0)
+      Chat::cancelConnect(session);
+
+    Items::dialog->hide();
+  }
+
+  // other sessions connect and reconnect without the dialog, a connect
+  // that fails at once reports before its session is known
+  void finished(Session *done)
+  {
+    if (Items::ok->active() != 0 || (session != 0 && done != session))
+      return;
+
+    Items::ok->activate();
+    Items::status->copy_label("");
     Items::dialog->hide();
   }
 
@@ -171,9 +195,70 @@ namespace Connect
                                  0);
     Items::keep_alive->value(0);
     Items::keep_alive->labelsize(18);
+    Items::auto_reconnect = new CheckBox(Items::dialog,
+                               0, 0, 0, 0,
+                               Language::get(Language::CONNECT_AUTO_RECONNECT),
+                               0);
+    Items::auto_reconnect->value(0);
+    Items::auto_reconnect->labelsize(18);
     Items::flex2->end();
 
-    int y1 = Items::flex2->y() + Items::flex2->h() + 16;
+    int y1 = Items::flex2->y() + Items::flex2->h() + 8;
+    Items::status = new Fl_Box(FL_NO_BOX, 8, y1,
+                               Items::dialog->w() - 16, 24, "");
+    Items::status->align(FL_ALIGN_INSIDE | FL_ALIGN_LEFT);
+    Items::status->labelsize(16);
+    y1 += 24 + 8;
+    Items::dialog->addOkCancelButtons(&Items::ok, &Items::cancel, &y1);
+    Items::ok->callback((Fl_Callback *)close);
+    Items::cancel->callback((Fl_Callback *)quit);
+    Items::dialog->set_modal();
+    Items::dialog->end(); 
+  }
+}
+
+namespace HighlightWords
+{
+  namespace Items
+  {
+    DialogWindow *dialog;
+    Fl_Input *words;
+    Fl_Button *ok;
+    Fl_Button *cancel;
+  }
+
+  void begin()
+  {
+    Items::words->value(Chat::keywords());
+    Items::ok->color(button_color);
+    Items::cancel->color(button_color);
+    Items::words->take_focus();
+    Items::dialog->show();
+  }
+
+  void close()
+  {
+    Chat::setKeywords(Items::words->value());
+    Items::dialog->hide();
+  }
+
+  void quit()
+  {
+    Items::dialog->hide();
+  }
+
+  void init()
+  {
+    int y1 = 32;
+
+    Items::dialog = new DialogWindow(480, 0,
+                                   Language::get(Language::HIGHLIGHT_WORDS));
+    Items::words = new Fl_Input(8, y1, Items::dialog->w() - 16, 32,
+                                Language::get(Language::HIGHLIGHT_WORDS_LIST));
+    Items::words->align(FL_ALIGN_TOP_LEFT);
+    Items::words->textsize(20);
+    Items::words->labelsize(18);
+    y1 += 32 + 16;
     Items::dialog->addOkCancelButtons(&Items::ok, &Items::cancel, &y1);
     Items::ok->callback((Fl_Callback *)close);
     Items::cancel->callback((Fl_Callback *)quit);
@@ -279,6 +364,7 @@ void Dialog::init()
 {
   About::init();
   Connect::init();
+  HighlightWords::init();
   Message::init();
   Choice::init();
 }
@@ -293,6 +379,16 @@ void Dialog::connectToServer()
   Connect::begin();
 }
 
+void Dialog::connectFinished(Session *session)
+{
+  Connect::finished(session);
+}
+
+void Dialog::highlightWords()
+{
+  HighlightWords::begin();
+}
+
 void Dialog::message(const char *title, const char *message)
 {
   Message::begin(title, message);
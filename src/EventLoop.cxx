@@ -0,0 +1,68 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include "EventLoop.H"
+
+namespace
+{
+  EventLoop::Backend *backend = 0;
+}
+
+// pick the backend once at startup, before anything connects
+void EventLoop::use(Backend *value)
+{
+  backend = value;
+}
+
+void EventLoop::addFd(const int fd, const int when,
+                      FdHandler *handler, void *data)
+{
+  backend->addFd(fd, when, handler, data);
+}
+
+void EventLoop::removeFd(const int fd, const int when)
+{
+  backend->removeFd(fd, when);
+}
+
+void EventLoop::addTimeout(const double seconds,
+                           TimeoutHandler *handler, void *data)
+{
+  backend->addTimeout(seconds, handler, data);
+}
+
+// from inside a timeout, counts from when that timeout was due
+void EventLoop::repeatTimeout(const double seconds,
+                              TimeoutHandler *handler, void *data)
+{
+  backend->repeatTimeout(seconds, handler, data);
+}
+
+// data is matched too, so one session's timeouts leave the others alone
+void EventLoop::removeTimeout(TimeoutHandler *handler, void *data)
+{
+  backend->removeTimeout(handler, data);
+}
+
+// safe from any thread, handler runs on the loop, 0 on success
+int EventLoop::awake(TimeoutHandler *handler, void *data)
+{
+  return backend->awake(handler, data);
+}
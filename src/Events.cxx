@@ -0,0 +1,75 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include "Events.H"
+#include "Trace.H"
+
+Events::Events()
+{
+}
+
+Events::~Events()
+{
+}
+
+// mask has bit (1 << type) set for each event type wanted, data is
+// passed back to the handler
+void Events::subscribe(const unsigned int mask, Handler *handler, void *data)
+{
+  subscribers.push_back({ mask, handler, data });
+}
+
+void Events::add(const Event &event)
+{
+  batch.push_back(event);
+}
+
+// every subscriber sees its events in order, each run of consecutive
+// matching events in one call
+void Events::dispatch()
+{
+  const int count = batch.size();
+  const Trace::Time traced = Trace::begin();
+
+  for (const Subscriber &sub : subscribers)
+  {
+    int i = 0;
+
+    while (i < count)
+    {
+      if ((sub.mask & (1u << batch[i].type)) == 0)
+      {
+        i++;
+        continue;
+      }
+
+      int j = i + 1;
+
+      while (j < count && (sub.mask & (1u << batch[j].type)) != 0)
+        j++;
+
+      sub.handler(batch.data() + i, j - i, sub.data);
+      i = j;
+    }
+  }
+
+  batch.clear();
+  Trace::end("dispatch", traced, "events", count);
+}
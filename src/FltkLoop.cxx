@@ -0,0 +1,111 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <vector>
+
+#include <FL/Fl.H>
+
+#include "FltkLoop.H"
+
+namespace
+{
+  struct watch
+  {
+    int fd;
+    int when;
+    EventLoop::FdHandler *handler;
+    void *data;
+  };
+
+  // FLTK hands back a pointer to one of these, its socket type isn't
+  // always an int
+  std::vector<watch *> watches;
+
+  void ready(FL_SOCKET, void *data)
+  {
+    watch *item = (watch *)data;
+
+    item->handler(item->fd, item->data);
+  }
+}
+
+FltkLoop::FltkLoop()
+{
+}
+
+FltkLoop::~FltkLoop()
+{
+}
+
+// like Fl::add_fd(), a new handler takes over the events it asks for
+void FltkLoop::addFd(const int fd, const int when,
+                     EventLoop::FdHandler *handler, void *data)
+{
+  removeFd(fd, when);
+
+  watch *item = new watch { fd, when, handler, data };
+
+  watches.push_back(item);
+  Fl::add_fd(fd, when, ready, item);
+}
+
+void FltkLoop::removeFd(const int fd, const int when)
+{
+  Fl::remove_fd(fd, when);
+
+  for (size_t i = 0; i < watches.size(); )
+  {
+    watch *item = watches[i];
+
+    if (item->fd == fd)
+      item->when &= ~when;
+
+    if (item->when == 0)
+    {
+      delete item;
+      watches.erase(watches.begin() + i);
+      continue;
+    }
+
+    i++;
+  }
+}
+
+void FltkLoop::addTimeout(const double seconds,
+                          EventLoop::TimeoutHandler *handler, void *data)
+{
+  Fl::add_timeout(seconds, handler, data);
+}
+
+void FltkLoop::repeatTimeout(const double seconds,
+                             EventLoop::TimeoutHandler *handler, void *data)
+{
+  Fl::repeat_timeout(seconds, handler, data);
+}
+
+void FltkLoop::removeTimeout(EventLoop::TimeoutHandler *handler, void *data)
+{
+  Fl::remove_timeout(handler, data);
+}
+
+int FltkLoop::awake(EventLoop::TimeoutHandler *handler, void *data)
+{
+  return Fl::awake(handler, data);
+}
@@ -18,24 +18,41 @@ along with JoeClient; if not, write to the Free Software
 Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
 */
 
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <vector>
 
 #include <FL/Fl_Box.H>
+#include <FL/Fl_Button.H>
 #include <FL/Fl_Double_Window.H>
 #include <FL/fl_draw.H>
 #include <FL/Fl_Flex.H>
 #include <FL/Fl_Group.H>
-#include <FL/Fl_Input.H>
 #include <FL/Fl_Menu_Bar.H>
+#include <FL/Fl_Native_File_Chooser.H>
+#include <FL/Fl_Tabs.H>
 #include <FL/Fl_Text_Display.H>
 #include <FL/Fl_Tile.H>
 #include <FL/Fl_Tooltip.H>
 
+#include "Capture.H"
 #include "Chat.H"
 #include "Dialog.H"
+#include "Events.H"
 #include "Gui.H"
+#include "Highlight.H"
+#include "InputField.H"
 #include "Language.H"
+#include "LatencyView.H"
+#include "Parser.H"
+#include "SendQueue.H"
+#include "Session.H"
+#include "Stats.H"
+#include "StatsWindow.H"
 #include "StyledText.H"
+#include "Tls.H"
+#include "Trace.H"
 #include "UrlBrowse.H"
 
 class MainWin;
@@ -54,12 +71,420 @@ namespace
   Fl_Group *bottom;
   Fl_Group *input_group;
   Fl_Box *input_bracket;
-  Fl_Input *input_field;
+  InputField *input_field;
+  LatencyView *latency_view;
+  Fl_Button *send_cancel;
 
-  StyledText *server_display;
-  StyledText *user_display;
-  UrlBrowse *url_display;
-  StyledText *pm_display;
+  // hidden until asked for from the help menu
+  StatsWindow *stats_window;
+
+  // one tab per session, the other panes show the selected session's
+  Fl_Tabs *session_tabs;
+  Fl_Group *user_stack;
+  Fl_Group *url_stack;
+  Fl_Group *pm_stack;
+
+  struct session_panes
+  {
+    Session *session;
+    StyledText *server;
+    StyledText *users;
+    UrlBrowse *urls;
+    StyledText *pms;
+  };
+
+  std::vector<session_panes *> panes;
+  session_panes *shown = 0;
+
+  // what new panes start out with
+  bool dark_theme = false;
+  int font_size = 16;
+
+  session_panes *find_panes(Session *session)
+  {
+    for (session_panes *p : panes)
+    {
+      if (p->session == session)
+        return p;
+    }
+
+    return 0;
+  }
+
+  // styles before and after the message start, by event type
+  struct pane_style
+  {
+    char before;
+    char after;
+  };
+
+  const pane_style server_styles[Event::TYPE_COUNT] =
+  {
+    { 'A', 'A' },
+    { 'C', 'A' },
+    { 'A', 'A' },
+    { 'B', 'D' },
+    { 'B', 'B' },
+    { 'A', 'A' },
+    { 'A', 'A' },
+    { 'A', 'A' },
+    { 'A', 'A' }
+  };
+
+  // highlights in the message part of lines from other people
+  int find_marks(Highlight *highlight, const Event *event, Event::Span *marks)
+  {
+    if (event->type == Event::CLIENT ||
+        highlight->isNick(event->line + event->nick.start,
+                          event->nick.length) == true)
+    {
+      return 0;
+    }
+
+    const int count = highlight->find(event->line + event->message.start,
+                                      event->message.length,
+                                      marks, Highlight::MAX_MARKS);
+
+    for (int i = 0; i < count; i++)
+      marks[i].start += event->message.start;
+
+    return count;
+  }
+
+  // lines that mention us are copied to the private message pane
+  void server_events(const Event *events, const int count, void *data)
+  {
+    const Trace::Time traced = Trace::begin();
+    session_panes *p = (session_panes *)data;
+    Highlight *highlight = p->session->highlight();
+    Event::Span marks[Highlight::MAX_MARKS];
+
+    for (int i = 0; i < count; i++)
+    {
+      const Event *event = &events[i];
+      const pane_style *style = &server_styles[event->type];
+      const int mark_count = find_marks(highlight, event, marks);
+
+      p->server->append(event->line, event->length,
+                        event->message.start, style->before, style->after,
+                        marks, mark_count);
+
+      if (mark_count > 0 && event->type != Event::PM)
+      {
+        p->pms->append(event->line, event->length,
+                       event->message.start, style->before, style->after,
+                       marks, mark_count);
+      }
+    }
+
+    Trace::end("appendServer", traced, "lines", count);
+  }
+
+  void pm_events(const Event *events, const int count, void *data)
+  {
+    const Trace::Time traced = Trace::begin();
+    session_panes *p = (session_panes *)data;
+    Highlight *highlight = p->session->highlight();
+    Event::Span marks[Highlight::MAX_MARKS];
+
+    for (int i = 0; i < count; i++)
+    {
+      const Event *event = &events[i];
+      const int mark_count = find_marks(highlight, event, marks);
+
+      p->pms->append(event->line, event->length,
+                     event->message.start, 'D', 'A', marks, mark_count);
+    }
+
+    Trace::end("appendPm", traced, "lines", count);
+  }
+
+  // how many keepalive probes may go unanswered
+  void setMissedProbes(Fl_Widget *, void *data)
+  {
+    Chat::setProbeLimit((int)(long)data);
+  }
+
+  // seconds between keepalive probes
+  void setProbeInterval(Fl_Widget *, void *data)
+  {
+    Chat::setProbeInterval((int)(long)data);
+  }
+
+  // outgoing line rates, in lines per second and lines per burst
+  struct send_rate
+  {
+    double rate;
+    int burst;
+  };
+
+  const send_rate send_rates[3] =
+  {
+    { 1, 3 },
+    { 2, 5 },
+    { 5, 10 }
+  };
+
+  void setSendRate(Fl_Widget *, void *data)
+  {
+    const send_rate *send = &send_rates[(long)data];
+
+    Chat::setSendRate(send->rate, send->burst);
+  }
+
+  void cancelSend(Fl_Widget *, void *)
+  {
+    Chat::cancelSend();
+  }
+
+  void closeStats(Fl_Widget *, void *)
+  {
+    Gui::toggleStats();
+  }
+
+  // asks where to capture to, choosing the item again stops it
+  void captureTraffic(Fl_Widget *, void *)
+  {
+    const char *item = Language::get(Language::SERVER_CAPTURE_TRAFFIC);
+
+    if (Capture::active() == true)
+    {
+      Capture::stop();
+    }
+      else
+    {
+      Fl_Native_File_Chooser chooser;
+
+      chooser.title(Language::get(Language::CAPTURE_SAVE_AS));
+      chooser.type(Fl_Native_File_Chooser::BROWSE_SAVE_FILE);
+      chooser.options(Fl_Native_File_Chooser::SAVEAS_CONFIRM);
+      chooser.filter("Captures\t*.jcap");
+
+      if (chooser.show() == 0 && Capture::start(chooser.filename()) == false)
+      {
+        Dialog::message(Language::get(Language::CAPTURE_SAVE_AS),
+                        Language::get(Language::CAPTURE_FAILED));
+      }
+    }
+
+    // the toggle flipped itself when chosen
+    if (Capture::active() == true)
+      Gui::setMenuItem(item);
+    else
+      Gui::clearMenuItem(item);
+  }
+
+  // chrome trace events until chosen again
+  void traceLoop(Fl_Widget *, void *)
+  {
+    const char *item = Language::get(Language::HELP_TRACE);
+
+    if (Trace::active() == true)
+    {
+      Trace::stop();
+    }
+      else
+    {
+      Fl_Native_File_Chooser chooser;
+
+      chooser.title(Language::get(Language::TRACE_SAVE_AS));
+      chooser.type(Fl_Native_File_Chooser::BROWSE_SAVE_FILE);
+      chooser.options(Fl_Native_File_Chooser::SAVEAS_CONFIRM);
+      chooser.filter("Traces\t*.json");
+
+      if (chooser.show() == 0 && Trace::start(chooser.filename()) == false)
+      {
+        Dialog::message(Language::get(Language::TRACE_SAVE_AS),
+                        Language::get(Language::TRACE_FAILED));
+      }
+    }
+
+    if (Trace::active() == true)
+      Gui::setMenuItem(item);
+    else
+      Gui::clearMenuItem(item);
+  }
+
+  // data is the speed, 0 is as fast as possible
+  void replayCapture(Fl_Widget *, void *data)
+  {
+    Fl_Native_File_Chooser chooser;
+
+    chooser.title(Language::get(Language::REPLAY_OPEN));
+    chooser.type(Fl_Native_File_Chooser::BROWSE_FILE);
+    chooser.filter("Captures\t*.jcap");
+
+    if (chooser.show() != 0)
+      return;
+
+    if (Chat::replay(chooser.filename(), (long)data) == false)
+    {
+      Dialog::message(Language::get(Language::REPLAY_OPEN),
+                      Language::get(Language::REPLAY_FAILED));
+    }
+  }
+
+  // "[N] name", the number in brackets is styled, the name isn't
+  int format_user(char *text, const int size, const int line,
+                  const char *name, int *split)
+  {
+    *split = snprintf(text, size, "[%d]", line);
+
+    const int length = *split + snprintf(text + *split, size - *split,
+                                         " %s\n", name);
+
+    // keep the newline if the name was cut short
+    if (length >= size)
+    {
+      text[size - 2] = '\n';
+      return size - 1;
+    }
+
+    return length;
+  }
+
+  void url_events(const Event *events, const int count, void *data)
+  {
+    const Trace::Time traced = Trace::begin();
+    session_panes *p = (session_panes *)data;
+
+    for (int i = 0; i < count; i++)
+    {
+      if (p->urls->size() >= 100)
+        p->urls->remove(1);
+
+      p->urls->add(events[i].line + events[i].message.start,
+                   events[i].message.length);
+    }
+
+    p->urls->bottomline(p->urls->size());
+    Trace::end("appendUrls", traced, "lines", count);
+  }
+
+  // pane colors follow the theme
+  void color_panes(session_panes *p)
+  {
+    if (dark_theme == true)
+    {
+      p->server->bgColor(fl_rgb_color(16, 16, 16));
+      p->urls->bgColor(fl_rgb_color(24, 24, 24));
+      p->pms->bgColor(fl_rgb_color(24, 24, 24));
+      p->users->bgColor(fl_rgb_color(24, 24, 24));
+    }
+      else
+    {
+      p->server->bgColor(fl_rgb_color(248, 248, 248));
+      p->urls->bgColor(fl_rgb_color(240, 240, 240));
+      p->pms->bgColor(fl_rgb_color(240, 240, 240));
+      p->users->bgColor(fl_rgb_color(240, 240, 240));
+    }
+  }
+
+  void size_panes(session_panes *p)
+  {
+    p->server->setFontSize(font_size);
+    p->urls->textsize(font_size);
+    p->urls->redraw();
+  }
+
+  void setFontSize(const int size)
+  {
+    font_size = size;
+
+    for (session_panes *p : panes)
+      size_panes(p);
+
+    Gui::getWindow()->redraw();
+  }
+
+  // tab label is where the session connects to
+  void label_tab(session_panes *p)
+  {
+    char text[256];
+
+    if (p->session->host()[0] == '\0')
+    {
+      p->server->copy_label(Language::get(Language::SESSION_NOT_CONNECTED));
+    }
+      else
+    {
+      snprintf(text, sizeof(text), "%s:%d",
+               p->session->host(), p->session->port());
+      p->server->copy_label(text);
+    }
+
+    session_tabs->redraw();
+  }
+
+  // what sessions report goes to their panes and the dialogs
+  class GuiView : public SessionView
+  {
+  public:
+    void append(Session *session, const char *text)
+    {
+      Gui::append(session, text);
+    }
+
+    void insertUser(Session *session, const int row, const int line,
+                    const char *name)
+    {
+      Gui::insertUser(session, row, line, name);
+    }
+
+    void updateUser(Session *session, const int row, const int line,
+                    const char *name)
+    {
+      Gui::updateUser(session, row, line, name);
+    }
+
+    void removeUser(Session *session, const int row)
+    {
+      Gui::removeUser(session, row);
+    }
+
+    void clearUsers(Session *session)
+    {
+      Gui::clearUsers(session);
+    }
+
+    void updateLatency(Session *session)
+    {
+      Gui::updateLatency(session);
+    }
+
+    void sendProgress(Session *session, const int sent, const int total)
+    {
+      Gui::sendProgress(session, sent, total);
+    }
+
+    void sessionChanged(Session *session)
+    {
+      Gui::sessionChanged(session);
+    }
+
+    void connectFinished(Session *session)
+    {
+      Dialog::connectFinished(session);
+    }
+
+    void message(Session *, const char *title, const char *text)
+    {
+      Dialog::message(title, text);
+    }
+  };
+
+  GuiView gui_view;
+
+  void selectSession(Fl_Widget *, void *)
+  {
+    Fl_Widget *tab = session_tabs->value();
+
+    for (session_panes *p : panes)
+    {
+      if (p->server == tab)
+        Chat::select(p->session);
+    }
+  }
 
   // quit program
   void quit()
@@ -67,6 +492,8 @@ namespace
     if (Dialog::choice(Language::get(Language::QUIT),
                        Language::get(Language::ARE_YOU_SURE)))
     {
+      Trace::stop();
+      Tls::saveCache();
       exit(0);
     }
   }
@@ -136,17 +563,32 @@ public:
     return Fl_Double_Window::handle(event);
   }
 
+  // each flush is one frame
+  void flush()
+  {
+    const Stats::Time started = Stats::start();
+    const Trace::Time traced = Trace::begin();
+
+    Fl_Double_Window::flush();
+    Stats::stop(Stats::REDRAW, started, 1);
+    Trace::end("flush", traced);
+  }
+
+  // children only, the rest of flush is copying the back buffer
   void draw()
   {
+    const Trace::Time traced = Trace::begin();
+
     Fl_Double_Window::draw();
+    Trace::end("draw", traced);
 
     // draw separator handles
-    const int x1 = user_display->x();
-    const int y1 = user_display->y();
-    const int h1 = user_display->h();
+    const int x1 = user_stack->x();
+    const int y1 = user_stack->y();
+    const int h1 = user_stack->h();
 
     const int cx = w() / 2;
-    const int cy = user_display->y() + user_display->h() / 2;
+    const int cy = user_stack->y() + user_stack->h() / 2;
 
     Fl_Color gray = fl_rgb_color(128, 128, 128);
 
@@ -220,7 +662,17 @@ void Gui::init()
   menubar->add(Language::get(Language::SERVER_CONNECT),
     0, (Fl_Callback *)Dialog::connectToServer, 0, 0);
   menubar->add(Language::get(Language::SERVER_DISCONNECT),
-    0, (Fl_Callback *)Chat::userDisconnected, 0, FL_MENU_DIVIDER);
+    0, (Fl_Callback *)Chat::userDisconnected, 0, 0);
+  menubar->add(Language::get(Language::SERVER_CLOSE_SESSION),
+    0, (Fl_Callback *)Chat::closeSession, 0, FL_MENU_DIVIDER);
+  menubar->add(Language::get(Language::SERVER_CAPTURE_TRAFFIC),
+    0, (Fl_Callback *)captureTraffic, 0, FL_MENU_TOGGLE);
+  menubar->add(Language::get(Language::SERVER_REPLAY_REAL_TIME),
+    0, (Fl_Callback *)replayCapture, (void *)1, 0);
+  menubar->add(Language::get(Language::SERVER_REPLAY_10X),
+    0, (Fl_Callback *)replayCapture, (void *)10, 0);
+  menubar->add(Language::get(Language::SERVER_REPLAY_FASTEST),
+    0, (Fl_Callback *)replayCapture, (void *)0, 0);
   menubar->add(Language::get(Language::SERVER_CLEAR_WEB_LINKS),
     0, (Fl_Callback *)clearURLs, 0, 0);
   menubar->add(Language::get(Language::SERVER_CLEAR_PRIVATE_MESSAGES),
@@ -237,13 +689,42 @@ void Gui::init()
   menubar->add(Language::get(Language::PREFERENCES_FONT_SIZE_MEDIUM),
     0, (Fl_Callback *)setFontMedium, 0, FL_MENU_RADIO);
   menubar->add(Language::get(Language::PREFERENCES_FONT_SIZE_LARGE),
-    0, (Fl_Callback *)setFontLarge, 0, FL_MENU_RADIO);
+    0, (Fl_Callback *)setFontLarge, 0, FL_MENU_RADIO | FL_MENU_DIVIDER);
+  menubar->add(Language::get(Language::PREFERENCES_NETWORK_THREAD),
+    0, (Fl_Callback *)setNetworkThread, 0, FL_MENU_TOGGLE | FL_MENU_DIVIDER);
+  menubar->add(Language::get(Language::PREFERENCES_HIGHLIGHT_WORDS),
+    0, (Fl_Callback *)Dialog::highlightWords, 0, 0);
+  menubar->add(Language::get(Language::PREFERENCES_MISSED_PROBES_2),
+    0, (Fl_Callback *)setMissedProbes, (void *)2, FL_MENU_RADIO);
+  menubar->add(Language::get(Language::PREFERENCES_MISSED_PROBES_3),
+    0, (Fl_Callback *)setMissedProbes, (void *)3, FL_MENU_RADIO);
+  menubar->add(Language::get(Language::PREFERENCES_MISSED_PROBES_5),
+    0, (Fl_Callback *)setMissedProbes, (void *)5, FL_MENU_RADIO);
+  menubar->add(Language::get(Language::PREFERENCES_PROBE_INTERVAL_1),
+    0, (Fl_Callback *)setProbeInterval, (void *)60, FL_MENU_RADIO);
+  menubar->add(Language::get(Language::PREFERENCES_PROBE_INTERVAL_2),
+    0, (Fl_Callback *)setProbeInterval, (void *)120, FL_MENU_RADIO);
+  menubar->add(Language::get(Language::PREFERENCES_PROBE_INTERVAL_5),
+    0, (Fl_Callback *)setProbeInterval, (void *)300, FL_MENU_RADIO);
+  menubar->add(Language::get(Language::PREFERENCES_SEND_RATE_SLOW),
+    0, (Fl_Callback *)setSendRate, (void *)0, FL_MENU_RADIO);
+  menubar->add(Language::get(Language::PREFERENCES_SEND_RATE_NORMAL),
+    0, (Fl_Callback *)setSendRate, (void *)1, FL_MENU_RADIO);
+  menubar->add(Language::get(Language::PREFERENCES_SEND_RATE_FAST),
+    0, (Fl_Callback *)setSendRate, (void *)2, FL_MENU_RADIO);
 
   setMenuItem(Language::get(Language::PREFERENCES_THEME_LIGHT));
   setMenuItem(Language::get(Language::PREFERENCES_FONT_SIZE_MEDIUM));
+  setMenuItem(Language::get(Language::PREFERENCES_MISSED_PROBES_3));
+  setMenuItem(Language::get(Language::PREFERENCES_PROBE_INTERVAL_2));
+  setMenuItem(Language::get(Language::PREFERENCES_SEND_RATE_NORMAL));
 
   menubar->add(Language::get(Language::HELP_ABOUT),
     0, (Fl_Callback *)Dialog::about, 0, 0);
+  menubar->add(Language::get(Language::HELP_STATS),
+    0, (Fl_Callback *)toggleStats, 0, FL_MENU_TOGGLE);
+  menubar->add(Language::get(Language::HELP_TRACE),
+    0, (Fl_Callback *)traceLoop, 0, FL_MENU_TOGGLE);
 
   // vertical group
   vertical = new Fl_Tile(0, menubar->h(),
@@ -255,40 +736,49 @@ void Gui::init()
                     window->w(), window->h() - 144 - menubar->h());
   top->box(FL_FLAT_BOX);
 
-  user_display = new StyledText(menubar->w() - 128, menubar->h(),
-                                128, top->h(), 100);
-  user_display->box(FL_UP_BOX);
-  top->size_range(user_display, 96, 256);
+  user_stack = new Fl_Group(menubar->w() - 128, menubar->h(),
+                            128, top->h());
+  user_stack->end();
+  top->size_range(user_stack, 96, 256);
 
   top_left = new Fl_Group(0, menubar->h(),
-                     window->w() - user_display->w(), top->h());
+                     window->w() - user_stack->w(), top->h());
 
   input_group = new Fl_Group(0, window->h() - 144 - 32, top_left->w(), 32, 0);
 
   input_bracket = new Fl_Box(input_group->x(), input_group->y(),
                              32, 32, ">");
 
-  input_field = new Fl_Input(32, window->h() - 144 - 32,
-                             top_left->w() - 32, 32, 0);
+  input_field = new InputField(32, window->h() - 144 - 32,
+                               top_left->w() - 32 - 128, 32, 0);
   input_field->align(FL_ALIGN_LEFT);
   input_field->box(FL_UP_BOX);
   input_field->textsize(18);
   input_field->when(FL_WHEN_ENTER_KEY);
   input_field->callback((Fl_Callback *)sendMessage);
 
+  latency_view = new LatencyView(input_group->x() + input_group->w() - 128,
+                                 input_group->y(), 128, 32);
+
+  // takes the place of the latency view while a paste is being sent
+  send_cancel = new Fl_Button(latency_view->x(), latency_view->y(), 128, 32);
+  send_cancel->tooltip(Language::get(Language::SEND_CANCEL_TIP));
+  send_cancel->callback((Fl_Callback *)cancelSend);
+  send_cancel->hide();
+
   input_group->resizable(input_field);
   input_group->end();
 
-  server_display = new StyledText(top_left->x(),
-                                  top_left->y(),
-                                  top_left->w(),
-                                  top_left->h() - input_field->h(),
-                                  1000);
-  server_display->box(FL_UP_BOX);
+  session_tabs = new Fl_Tabs(top_left->x(),
+                              top_left->y(),
+                              top_left->w(),
+                              top_left->h() - input_field->h());
+  session_tabs->callback(selectSession);
+  session_tabs->end();
 
   input_field->box(FL_UP_BOX);
 
-  top_left->resizable(server_display);
+  top_left->resizable(session_tabs);
   top_left->end();
 
   top->size_range(top_left, 544, 256);
@@ -298,12 +788,13 @@ void Gui::init()
   // bottom group
   bottom = new Fl_Group(0, window->h() - 144, window->w(), 144);
 
-  url_display = new UrlBrowse(bottom->x(), bottom->y(),
-                              bottom->w() / 2, bottom->h());
+  url_stack = new Fl_Group(bottom->x(), bottom->y(),
+                           bottom->w() / 2, bottom->h());
+  url_stack->end();
 
-  pm_display = new StyledText(bottom->w() / 2, bottom->y(),
-                              bottom->w() / 2, bottom->h(), 100);
-  pm_display->box(FL_UP_BOX);
+  pm_stack = new Fl_Group(bottom->w() / 2, bottom->y(),
+                          bottom->w() / 2, bottom->h());
+  pm_stack->end();
 
   bottom->resizable(bottom);
   bottom->end();
@@ -317,9 +808,14 @@ void Gui::init()
   window->resizable(vertical);
   window->end();
 
+  stats_window = new StatsWindow();
+  stats_window->callback(closeStats);
+
   setFontMedium();
   setLightTheme();
-  clearURLs();
+
+  Session::setView(&gui_view);
+
 //  Gui::deactivateMenuItem("&Server/&Disconnect");
   Gui::deactivateMenuItem(Language::get(Language::SERVER_DISCONNECT));
 }
@@ -360,76 +856,236 @@ Fl_Menu_Bar *Gui::getMenuBar()
   return menubar;
 }
 
-void Gui::append(const char *text)
+// panes for a new session, the session's events go straight to them
+void Gui::addSession(Session *session)
 {
-  const char c = text[0];
+  session_panes *p = new session_panes;
+  int x, y, w, h;
+
+  session_tabs->client_area(x, y, w, h);
+  Fl_Group::current(0);
+
+  p->session = session;
+  p->server = new StyledText(x, y, w, h, 1000);
+  p->server->box(FL_UP_BOX);
+  session_tabs->add(p->server);
+
+  p->users = new StyledText(user_stack->x(), user_stack->y(),
+                            user_stack->w(), user_stack->h(), 100);
+  p->users->box(FL_UP_BOX);
+  p->users->hide();
+  user_stack->add(p->users);
+
+  p->urls = new UrlBrowse(url_stack->x(), url_stack->y(),
+                          url_stack->w(), url_stack->h());
+  p->urls->hide();
+  url_stack->add(p->urls);
+
+  p->pms = new StyledText(pm_stack->x(), pm_stack->y(),
+                          pm_stack->w(), pm_stack->h(), 100);
+  p->pms->box(FL_UP_BOX);
+  p->pms->hide();
+  pm_stack->add(p->pms);
+
+  panes.push_back(p);
+  label_tab(p);
+  color_panes(p);
+  size_panes(p);
+
+  session->events()->subscribe(1u << Event::TEXT | 1u << Event::CHAT |
+                               1u << Event::PM | 1u << Event::NOTICE |
+                               1u << Event::CLIENT, server_events, p);
+  session->events()->subscribe(1u << Event::PM, pm_events, p);
+  session->events()->subscribe(1u << Event::URL, url_events, p);
+}
 
-  if (c == '[')
-  {
-    server_display->append(text, "[", ": ", 'C', 'A');
-  }
-  else if (c == '>')
-  {
-    server_display->append(text, ">>", "", 'B', 'B');
-  }
-  else if (c == '(')
+void Gui::removeSession(Session *session)
+{
+  session_panes *p = find_panes(session);
+
+  if (p == shown)
+    shown = 0;
+
+  session_tabs->remove(p->server);
+  user_stack->remove(p->users);
+  url_stack->remove(p->urls);
+  pm_stack->remove(p->pms);
+
+  Fl::delete_widget(p->server);
+  Fl::delete_widget(p->users);
+  Fl::delete_widget(p->urls);
+  Fl::delete_widget(p->pms);
+
+  for (size_t i = 0; i < panes.size(); i++)
   {
-    server_display->append(text, "(", "using", 'B', 'D');
+    if (panes[i] == p)
+    {
+      panes.erase(panes.begin() + i);
+      break;
+    }
   }
-    else
+
+  delete p;
+}
+
+// bring the session's tab to the front along with its other panes
+void Gui::showSession(Session *session)
+{
+  session_panes *p = find_panes(session);
+
+  if (shown != 0)
   {
-    server_display->append(text);
+    shown->users->hide();
+    shown->urls->hide();
+    shown->pms->hide();
   }
+
+  shown = p;
+  session_tabs->value(p->server);
+  p->users->show();
+  p->urls->show();
+  p->pms->show();
+
+  sessionChanged(session);
+  session->sendQueue()->showProgress();
+  latency_view->update();
+  window->redraw();
 }
 
-void Gui::appendUser(int line, const char *name)
+// the session started or stopped connecting
+void Gui::sessionChanged(Session *session)
+{
+  session_panes *p = find_panes(session);
+
+  label_tab(p);
+
+  if (p != shown)
+    return;
+
+  if (session->isConnected() == true || session->isConnecting() == true)
+    activateMenuItem(Language::get(Language::SERVER_DISCONNECT));
+  else
+    deactivateMenuItem(Language::get(Language::SERVER_DISCONNECT));
+}
+
+void Gui::append(Session *session, const char *text)
+{
+  append(session, text, strlen(text));
+}
+
+// local messages, text doesn't need to be null-terminated
+void Gui::append(Session *session, const char *text, const int length)
+{
+  Event events[Parser::MAX_EVENTS];
+
+  Parser::scan(text, length, events);
+  server_events(events, 1, find_panes(session));
+}
+
+// user pane rows are kept in slot order, edited one row at a time
+void Gui::insertUser(Session *session, const int row, const int line,
+                     const char *name)
 {
   char text[256];
+  int split = 0;
+  const int length = format_user(text, sizeof(text), line, name, &split);
 
-  snprintf(text, sizeof(text), "[%d] %s", line, name);
-  user_display->append(text, "[", "]", 'F', 'A');
+  find_panes(session)->users->insertLine(row, text, length,
+                                         split, 'F', 'A');
+}
 
-  if (name[strlen(text) - 1] != '\n')
-  {
-    user_display->append("\n"); 
-  }
+void Gui::updateUser(Session *session, const int row, const int line,
+                     const char *name)
+{
+  char text[256];
+  int split = 0;
+  const int length = format_user(text, sizeof(text), line, name, &split);
+
+  find_panes(session)->users->replaceLine(row, text, length,
+                                          split, 'F', 'A');
 }
 
-void Gui::appendURL(const char *text)
+void Gui::removeUser(Session *session, const int row)
 {
-  if (url_display->size() >= 100)
-    url_display->remove(1);
+  find_panes(session)->users->removeLine(row);
+}
 
-  url_display->add(text);
-  url_display->bottomline(url_display->size());
+// only the shown session's latency is on screen
+void Gui::updateLatency(Session *session)
+{
+  if (shown != 0 && shown->session == session)
+    latency_view->update();
 }
 
-void Gui::appendPM(const char *text)
+// lines sent out of the total queued, a total of zero means done, only
+// the shown session's queue has the cancel button
+void Gui::sendProgress(Session *session, const int sent, const int total)
 {
-  pm_display->append(text, "<", ":", 'D', 'A');
+  if (shown == 0 || shown->session != session)
+    return;
+
+  if (total == 0)
+  {
+    send_cancel->hide();
+    latency_view->show();
+    return;
+  }
+
+  char text[64];
 
-  if (text[strlen(text) - 1] != '\n')
-    pm_display->append("\n"); 
+  snprintf(text, sizeof(text), Language::get(Language::SEND_PROGRESS),
+           sent, total);
+  send_cancel->copy_label(text);
+  latency_view->hide();
+  send_cancel->show();
 }
 
-void Gui::clearUsers()
+void Gui::clearUsers(Session *session)
 {
-  user_display->clear();
+  find_panes(session)->users->clear();
 }
 
 void Gui::clearURLs()
 {
-  url_display->clear();
+  shown->urls->clear();
 }
 
 void Gui::clearPMs()
 {
-  pm_display->clear();
+  shown->pms->clear();
+}
+
+// text held by every session's panes
+int Gui::scrollbackBytes()
+{
+  int bytes = 0;
+
+  for (session_panes *p : panes)
+    bytes += p->server->bytes() + p->users->bytes() + p->pms->bytes();
+
+  return bytes;
+}
+
+// the menu item follows the window, closing it also turns timing off
+void Gui::toggleStats()
+{
+  const char *item = Language::get(Language::HELP_STATS);
+
+  if (stats_window->shown())
+  {
+    stats_window->hide();
+    clearMenuItem(item);
+  }
+    else
+  {
+    stats_window->show();
+    setMenuItem(item);
+  }
 }
 
 void Gui::sendMessage()
 {
-  Chat::write(input_field->value());
+  Chat::send(input_field->value());
   input_field->value("");
 }
 
@@ -443,10 +1099,11 @@ void Gui::setLightTheme()
  
   menubar->color(fl_rgb_color(240, 240, 240));
   input_field->color(fl_rgb_color(248, 248, 248));
-  server_display->bgColor(fl_rgb_color(248, 248, 248));
-  url_display->bgColor(fl_rgb_color(240, 240, 240));
-  pm_display->bgColor(fl_rgb_color(240, 240, 240));
-  user_display->bgColor(fl_rgb_color(240, 240, 240));
+  dark_theme = false;
+
+  for (session_panes *p : panes)
+    color_panes(p);
+
   Dialog::setButtonColor(fl_rgb_color(248, 248, 248));
   getWindow()->redraw();
 }
@@ -461,36 +1118,37 @@ void Gui::setDarkTheme()
 
   menubar->color(fl_rgb_color(24, 24, 24));
   input_field->color(fl_rgb_color(16, 16, 16));
-  server_display->bgColor(fl_rgb_color(16, 16, 16));
-  url_display->bgColor(fl_rgb_color(24, 24, 24));
-  pm_display->bgColor(fl_rgb_color(24, 24, 24));
-  user_display->bgColor(fl_rgb_color(24, 24, 24));
+  dark_theme = true;
+
+  for (session_panes *p : panes)
+    color_panes(p);
+
   Dialog::setButtonColor(fl_rgb_color(32, 32, 32));
   getWindow()->redraw();
 }
 
 void Gui::setFontSmall()
 {
-  server_display->setFontSize(14);
-  url_display->textsize(14);
-  url_display->redraw();
-  window->redraw();
+  setFontSize(14);
 }
 
 void Gui::setFontMedium()
 {
-  server_display->setFontSize(16);
-  url_display->textsize(16);
-  url_display->redraw();
-  window->redraw();
+  setFontSize(16);
 }
 
 void Gui::setFontLarge()
 {
-  server_display->setFontSize(18);
-  url_display->textsize(18);
-  url_display->redraw();
-  window->redraw();
+  setFontSize(18);
+}
+
+void Gui::setNetworkThread()
+{
+  const Fl_Menu_Item *item =
+    menubar->find_item(Language::get(Language::PREFERENCES_NETWORK_THREAD));
+
+  if (item)
+    Chat::setThreaded(item->value() != 0);
 }
 
 void Gui::activateMenuItem(const char *desc)
@@ -0,0 +1,515 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+  #include <unistd.h>
+#endif
+
+#include "Capture.H"
+#include "EventLoop.H"
+#include "Events.H"
+#include "Headless.H"
+#include "LineBuffer.H"
+#include "PollLoop.H"
+#include "Replay.H"
+#include "Session.H"
+#include "Tls.H"
+#include "Trace.H"
+
+namespace
+{
+  const char *usage =
+    "usage: joeclient --headless [options] host[:port] ...\n"
+    "       joeclient-headless [options] host[:port] ...\n"
+    "       joeclient-headless [options] --replay FILE [--speed N]\n"
+    "\n"
+    "options: --json --ssl --keep-alive --reconnect --threaded\n"
+    "         --capture FILE --trace FILE\n"
+    "\n"
+    "Lines read from stdin go to every connected server, or to just\n"
+    "one with \"@N message\" where N counts servers from 0.\n"
+    "\n"
+    "--capture records everything the servers send to FILE. --replay\n"
+    "plays such a file back instead of connecting, N times as fast as\n"
+    "it was recorded (default 1), or as fast as possible with 0.\n"
+    "--trace writes Chrome trace events for the event loop's work to\n"
+    "FILE, to open in Perfetto or chrome://tracing.\n";
+
+  const int default_port = 6666;
+
+  const char *type_names[Event::TYPE_COUNT] =
+  {
+    "text",
+    "chat",
+    "pm",
+    "notice",
+    "client",
+    "join",
+    "leave",
+    "list",
+    "url"
+  };
+
+  bool json = false;
+
+  // stdin is read once the first connects are over, so piped lines
+  // aren't dropped while connecting
+  bool input_watched = false;
+  bool input_open = true;
+
+  std::vector<Session *> sessions;
+  LineBuffer input;
+
+  int index_of(Session *session)
+  {
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+      if (sessions[i] == session)
+        return i;
+    }
+
+    return -1;
+  }
+
+  // JSON string with quotes, bytes from 0x80 up are passed through
+  void put_string(const char *text, const int length)
+  {
+    putchar('"');
+
+    for (int i = 0; i < length; i++)
+    {
+      const unsigned char c = text[i];
+
+      if (c == '"' || c == '\\')
+      {
+        putchar('\\');
+        putchar(c);
+      }
+      else if (c < 0x20)
+      {
+        printf("\\u%04x", c);
+      }
+        else
+      {
+        putchar(c);
+      }
+    }
+
+    putchar('"');
+  }
+
+  void put_field(const char *name, const char *text, const int length)
+  {
+    printf(",\"%s\":", name);
+    put_string(text, length);
+  }
+
+  // lines from the server, the newline is left off
+  void print_events(const Event *events, const int count, void *data)
+  {
+    const int index = (long)data;
+
+    for (int i = 0; i < count; i++)
+    {
+      const Event *event = &events[i];
+      const char *name = type_names[event->type];
+      int length = event->length;
+
+      if (length > 0 && event->line[length - 1] == '\n')
+        length--;
+
+      if (json == false)
+      {
+        if (event->type == Event::URL)
+        {
+          printf("%d %s %.*s\n", index, name, event->message.length,
+                 event->line + event->message.start);
+        }
+          else
+        {
+          printf("%d %s %.*s\n", index, name, length, event->line);
+        }
+
+        continue;
+      }
+
+      printf("{\"session\":%d,\"type\":\"%s\"", index, name);
+
+      if (event->type == Event::URL)
+      {
+        put_field("url", event->line + event->message.start,
+                  event->message.length);
+        printf("}\n");
+        continue;
+      }
+
+      if (event->type == Event::JOIN || event->type == Event::LEAVE)
+        printf(",\"id\":%d", event->id);
+
+      if (event->nick.length > 0)
+      {
+        put_field("nick", event->line + event->nick.start,
+                  event->nick.length);
+      }
+
+      if (event->message.start > 0 && event->message.start < length)
+      {
+        put_field("message", event->line + event->message.start,
+                  length - event->message.start);
+      }
+
+      put_field("line", event->line, length);
+      printf("}\n");
+    }
+  }
+
+  // local messages and state changes, errors go to stderr
+  class HeadlessView : public SessionView
+  {
+  public:
+    void append(Session *session, const char *text)
+    {
+      int length = strlen(text);
+
+      if (length > 0 && text[length - 1] == '\n')
+        length--;
+
+      if (json == true)
+      {
+        printf("{\"session\":%d,\"type\":\"client\"", index_of(session));
+        put_field("line", text, length);
+        printf("}\n");
+      }
+        else
+      {
+        printf("%d client %.*s\n", index_of(session), length, text);
+      }
+    }
+
+    void updateLatency(Session *session)
+    {
+      const Chat::LatencyStats *stats = session->latencyStats();
+
+      if (json == true)
+      {
+        printf("{\"session\":%d,\"type\":\"latency\",\"ms\":%.1f,"
+               "\"kernel_ms\":%.1f,\"missed\":%d}\n", index_of(session),
+               stats->last_ms, stats->kernel_ms, stats->missed);
+      }
+        else
+      {
+        printf("%d latency %.1f ms (kernel %.1f ms, %d missed)\n",
+               index_of(session), stats->last_ms, stats->kernel_ms,
+               stats->missed);
+      }
+    }
+
+    void sessionChanged(Session *session)
+    {
+      const char *state = session->isConnected() ? "connected" :
+                          session->isConnecting() ? "connecting" : "closed";
+
+      if (json == true)
+      {
+        printf("{\"session\":%d,\"type\":\"state\",\"state\":\"%s\"",
+               index_of(session), state);
+        put_field("host", session->host(), strlen(session->host()));
+        printf(",\"port\":%d}\n", session->port());
+      }
+        else
+      {
+        printf("%d state %s %s:%d\n", index_of(session), state,
+               session->host(), session->port());
+      }
+    }
+
+    void message(Session *session, const char *title, const char *text)
+    {
+      fprintf(stderr, "%d %s: %s\n", index_of(session), title, text);
+    }
+  };
+
+  HeadlessView view;
+
+  // "@N message" picks a server, anything else goes to all of them
+  void send_line(char *line, const int length)
+  {
+    line[length] = '\0';
+
+    if (line[0] == '@')
+    {
+      char *end;
+      const long index = strtol(line + 1, &end, 10);
+
+      if (end > line + 1 && *end == ' ' &&
+          index >= 0 && index < (long)sessions.size())
+      {
+        sessions[index]->write(end + 1);
+        return;
+      }
+    }
+
+    for (Session *session : sessions)
+    {
+      if (session->isConnected() == true)
+        session->write(line);
+    }
+  }
+
+  void read_input(int fd, void *)
+  {
+#ifdef WIN32
+    const int size = -1;
+#else
+    const int size = read(fd, input.reserve(4096), 4096);
+#endif
+
+    if (size <= 0)
+    {
+      EventLoop::removeFd(fd);
+      input_open = false;
+      return;
+    }
+
+    input.commit(size);
+
+    char *line;
+    int length = 0;
+
+    while ((line = input.nextLine(&length)) != 0)
+    {
+      if (length > 0)
+        send_line(line, length);
+    }
+  }
+
+  // replayed streams are numbered after any servers
+  Session *replay_session(const int)
+  {
+    Session *session = new Session();
+
+    sessions.push_back(session);
+    session->events()->subscribe(~0u, print_events,
+                                 (void *)(long)(sessions.size() - 1));
+
+    return session;
+  }
+
+  // after the events, so it can be told apart from them on a terminal
+  void replay_done(const char *summary)
+  {
+    fflush(stdout);
+    fprintf(stderr, "%s\n", summary);
+  }
+
+  bool add_server(const char *arg, const bool ssl, const bool keep_alive,
+                  const bool reconnect, const bool threaded)
+  {
+    std::string host = arg;
+    int port = default_port;
+    const size_t colon = host.rfind(':');
+
+    // a bare IPv6 address has colons but no port
+    if (colon != std::string::npos &&
+        (host.find(':') == colon || host[0] == '['))
+    {
+      port = atoi(host.c_str() + colon + 1);
+      host.erase(colon);
+    }
+
+    if (host.size() > 1 && host[0] == '[' && host[host.size() - 1] == ']')
+      host = host.substr(1, host.size() - 2);
+
+    if (host.empty() == true || port <= 0 || port > 65535)
+      return false;
+
+    Session *session = new Session();
+
+    sessions.push_back(session);
+    session->setThreaded(threaded);
+    session->events()->subscribe(~0u, print_events,
+                                 (void *)(long)(sessions.size() - 1));
+    session->connect(host.c_str(), port, ssl, keep_alive, reconnect);
+
+    return true;
+  }
+
+  bool busy()
+  {
+    for (Session *session : sessions)
+    {
+      if (session->isConnected() == true || session->isConnecting() == true)
+        return true;
+    }
+
+    return false;
+  }
+
+  void watch_input()
+  {
+    for (Session *session : sessions)
+    {
+      if (session->isConnecting() == true)
+        return;
+    }
+
+#ifndef WIN32
+    EventLoop::addFd(0, EventLoop::READ, read_input, 0);
+#endif
+
+    input_watched = true;
+  }
+}
+
+// arguments are the ones after --headless, runs until every server
+// has gone away for good
+int Headless::run(int argc, char **argv)
+{
+  bool ssl = false;
+  bool keep_alive = false;
+  bool reconnect = false;
+  bool threaded = false;
+  bool bad_option = false;
+  const char *capture = 0;
+  const char *replay = 0;
+  const char *trace = 0;
+  double speed = 1;
+  std::vector<const char *> servers;
+
+  for (int i = 0; i < argc; i++)
+  {
+    // options that take a value
+    if (i + 1 < argc)
+    {
+      if (strcmp(argv[i], "--capture") == 0)
+      {
+        capture = argv[++i];
+        continue;
+      }
+
+      if (strcmp(argv[i], "--replay") == 0)
+      {
+        replay = argv[++i];
+        continue;
+      }
+
+      if (strcmp(argv[i], "--trace") == 0)
+      {
+        trace = argv[++i];
+        continue;
+      }
+
+      if (strcmp(argv[i], "--speed") == 0)
+      {
+        speed = atof(argv[++i]);
+        continue;
+      }
+    }
+
+    if (strcmp(argv[i], "--json") == 0)
+      json = true;
+    else if (strcmp(argv[i], "--ssl") == 0)
+      ssl = true;
+    else if (strcmp(argv[i], "--keep-alive") == 0)
+      keep_alive = true;
+    else if (strcmp(argv[i], "--reconnect") == 0)
+      reconnect = true;
+    else if (strcmp(argv[i], "--threaded") == 0)
+      threaded = true;
+    else if (argv[i][0] != '-')
+      servers.push_back(argv[i]);
+    else
+      bad_option = true;
+  }
+
+  if ((servers.empty() == true && replay == 0) || bad_option == true ||
+      speed < 0)
+  {
+    fputs(usage, stderr);
+    return 2;
+  }
+
+#ifndef WIN32
+  signal(SIGPIPE, SIG_IGN);
+#endif
+
+  PollLoop loop;
+
+  EventLoop::use(&loop);
+  Session::setView(&view);
+
+  if (capture != 0 && Capture::start(capture) == false)
+  {
+    fprintf(stderr, "can't write capture file: %s\n", capture);
+    return 1;
+  }
+
+  if (trace != 0 && Trace::start(trace) == false)
+  {
+    fprintf(stderr, "can't write trace file: %s\n", trace);
+    return 1;
+  }
+
+  for (const char *server : servers)
+  {
+    if (add_server(server, ssl, keep_alive, reconnect, threaded) == false)
+    {
+      fprintf(stderr, "bad server address: %s\n", server);
+      return 2;
+    }
+  }
+
+  if (replay != 0 &&
+      Replay::start(replay, speed, replay_session, replay_done) == false)
+  {
+    fprintf(stderr, "not a capture file: %s\n", replay);
+    return 1;
+  }
+
+  while (busy() == true || Replay::running() == true)
+  {
+    if (input_watched == false)
+      watch_input();
+
+    loop.wait(1.0);
+    fflush(stdout);
+  }
+
+  if (input_watched == true && input_open == true)
+    EventLoop::removeFd(0);
+
+  Capture::stop();
+  Trace::stop();
+  Tls::saveCache();
+
+  for (Session *session : sessions)
+    delete session;
+
+  sessions.clear();
+
+  return 0;
+}
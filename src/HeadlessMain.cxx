@@ -0,0 +1,33 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <openssl/ssl.h>
+
+#include "Headless.H"
+
+// the headless client on its own, linked without FLTK
+int main(int argc, char *argv[])
+{
+  SSL_load_error_strings();
+  OpenSSL_add_ssl_algorithms();
+  SSL_library_init();
+
+  return Headless::run(argc - 1, argv + 1);
+}
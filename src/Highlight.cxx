@@ -0,0 +1,251 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Events.H"
+#include "Highlight.H"
+
+namespace
+{
+  // ascii capitals and the latin-1 capitals U+00C0 to U+00DE (utf-8
+  // C3 80 to C3 9E, except the multiplication sign) fold to lower case,
+  // prev is the raw byte before c
+  unsigned char fold(const unsigned char prev, const unsigned char c)
+  {
+    if (c >= 'A' && c <= 'Z')
+      return c + 32;
+
+    if (prev == 0xc3 && c >= 0x80 && c <= 0x9e && c != 0x97)
+      return c + 0x20;
+
+    return c;
+  }
+
+  std::string fold_string(const std::string &s)
+  {
+    std::string folded(s);
+    unsigned char prev = 0;
+
+    for (size_t i = 0; i < s.size(); i++)
+    {
+      folded[i] = fold(prev, s[i]);
+      prev = s[i];
+    }
+
+    return folded;
+  }
+}
+
+Highlight::Highlight()
+{
+  memset(byte_class, 0, sizeof(byte_class));
+  class_count = 1;
+  next.assign(1, 0);
+  match_length.assign(1, 0);
+}
+
+Highlight::~Highlight()
+{
+}
+
+// learned from our own .n command
+void Highlight::setNick(const char *name)
+{
+  nick = name;
+
+  while (nick.empty() == false && nick.back() == ' ')
+    nick.pop_back();
+
+  build();
+}
+
+void Highlight::setKeywords(const char *list)
+{
+  keyword_list = list;
+  build();
+}
+
+bool Highlight::isNick(const char *name, const int length)
+{
+  return nick.empty() == false &&
+         fold_string(nick) == fold_string(std::string(name, length));
+}
+
+// the automaton for the nick and the keywords together
+void Highlight::build()
+{
+  std::vector<std::string> patterns;
+
+  if (nick.empty() == false)
+    patterns.push_back(fold_string(nick));
+
+  // comma separated, spaces around each word don't count
+  size_t pos = 0;
+
+  while (pos <= keyword_list.size())
+  {
+    size_t end = keyword_list.find(',', pos);
+
+    if (end == std::string::npos)
+      end = keyword_list.size();
+
+    size_t first = pos;
+    size_t last = end;
+
+    while (first < last && keyword_list[first] == ' ')
+      first++;
+
+    while (last > first && keyword_list[last - 1] == ' ')
+      last--;
+
+    if (last > first)
+      patterns.push_back(fold_string(keyword_list.substr(first, last - first)));
+
+    pos = end + 1;
+  }
+
+  // bytes that appear in no pattern all share class 0
+  memset(byte_class, 0, sizeof(byte_class));
+  class_count = 1;
+
+  for (const std::string &pattern : patterns)
+  {
+    for (const char c : pattern)
+    {
+      if (byte_class[(unsigned char)c] == 0)
+        byte_class[(unsigned char)c] = class_count++;
+    }
+  }
+
+  // trie of the patterns, -1 where there is no edge yet
+  next.assign(class_count, -1);
+  match_length.assign(1, 0);
+
+  for (const std::string &pattern : patterns)
+  {
+    int state = 0;
+
+    for (const char c : pattern)
+    {
+      int &edge = next[state * class_count + byte_class[(unsigned char)c]];
+
+      if (edge < 0)
+      {
+        edge = match_length.size();
+        match_length.push_back(0);
+        next.resize(next.size() + class_count, -1);
+      }
+
+      state = next[state * class_count + byte_class[(unsigned char)c]];
+    }
+
+    match_length[state] = std::max(match_length[state], (int)pattern.size());
+  }
+
+  // breadth first, fill in the missing edges from the failure links
+  std::vector<int> fail(match_length.size(), 0);
+  std::vector<int> queue;
+
+  for (int c = 0; c < class_count; c++)
+  {
+    int &edge = next[c];
+
+    if (edge < 0)
+    {
+      edge = 0;
+    }
+      else
+    {
+      fail[edge] = 0;
+      queue.push_back(edge);
+    }
+  }
+
+  for (size_t i = 0; i < queue.size(); i++)
+  {
+    const int state = queue[i];
+
+    for (int c = 0; c < class_count; c++)
+    {
+      const int child = next[state * class_count + c];
+      const int fallback = next[fail[state] * class_count + c];
+
+      if (child < 0)
+      {
+        next[state * class_count + c] = fallback;
+        continue;
+      }
+
+      fail[child] = fallback;
+      match_length[child] = std::max(match_length[child],
+                                     match_length[fallback]);
+      queue.push_back(child);
+    }
+  }
+}
+
+// mark every match in text, overlapping ones are merged, returns how
+// many spans were written
+int Highlight::find(const char *text, const int length,
+                    Event::Span *marks, const int max_marks)
+{
+  int count = 0;
+  int state = 0;
+  unsigned char prev = 0;
+
+  if (match_length.size() <= 1)
+    return 0;
+
+  for (int i = 0; i < length; i++)
+  {
+    const unsigned char c = fold(prev, text[i]);
+
+    prev = text[i];
+    state = next[state * class_count + byte_class[c]];
+
+    if (match_length[state] == 0)
+      continue;
+
+    const int start = i + 1 - match_length[state];
+
+    if (count > 0 &&
+        start <= marks[count - 1].start + marks[count - 1].length)
+    {
+      Event::Span *last = &marks[count - 1];
+
+      if (start < last->start)
+        last->start = start;
+
+      last->length = i + 1 - last->start;
+    }
+    else if (count < max_marks)
+    {
+      marks[count].start = start;
+      marks[count].length = match_length[state];
+      count++;
+    }
+  }
+
+  return count;
+}
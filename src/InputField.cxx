@@ -0,0 +1,100 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <FL/Fl.H>
+#include <FL/Fl_Input.H>
+
+#include "Chat.H"
+#include "InputField.H"
+
+InputField::InputField(int x, int y, int w, int h, const char *label)
+: Fl_Input(x, y, w, h, label)
+{
+  candidate = 0;
+  word_start = 0;
+  word_end = 0;
+  completing = false;
+}
+
+InputField::~InputField()
+{
+}
+
+int InputField::handle(int event)
+{
+  if (event == FL_KEYBOARD)
+  {
+    if (Fl::event_key() == FL_Tab &&
+        (Fl::event_state() & (FL_SHIFT | FL_CTRL | FL_ALT)) == 0)
+    {
+      complete();
+      return 1;
+    }
+
+    completing = false;
+  }
+  else if (event == FL_PUSH)
+  {
+    completing = false;
+  }
+
+  return Fl_Input::handle(event);
+}
+
+// complete the word before the cursor, pressing tab again right away
+// cycles through the other matches
+void InputField::complete()
+{
+  const int pos = insert_position();
+
+  if (completing == true && pos == word_end && candidates.size() > 1)
+  {
+    candidate = (candidate + 1) % candidates.size();
+  }
+    else
+  {
+    const char *text = value();
+    int start = pos;
+
+    while (start > 0 && text[start - 1] != ' ')
+      start--;
+
+    completing = false;
+
+    if (start == pos ||
+        Chat::completeNick(text + start, pos - start, &candidates) == 0)
+    {
+      return;
+    }
+
+    word_start = start;
+    candidate = 0;
+    completing = true;
+  }
+
+  const std::string &nick = candidates[candidate];
+
+  replace(word_start, pos, nick.c_str(), nick.size());
+  word_end = word_start + nick.size();
+  insert_position(word_end);
+}
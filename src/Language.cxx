@@ -26,6 +26,11 @@ namespace
   {
     "Server/Connect",
     "Server/Disconnect",
+    "Server/Close Session",
+    "Server/Capture Traffic...",
+    "Server/Replay Capture/Real Time...",
+    "Server/Replay Capture/10x Speed...",
+    "Server/Replay Capture/As Fast As Possible...",
     "Server/Clear Web Links",
     "Server/Clear Private Messages",
     "Server/Quit",
@@ -34,13 +39,41 @@ namespace
     "Preferences/Font Size/Small",
     "Preferences/Font Size/Medium",
     "Preferences/Font Size/Large",
+    "Preferences/Network Thread",
+    "Preferences/Highlight Words...",
+    "Preferences/Missed Probes Before Reconnect/2",
+    "Preferences/Missed Probes Before Reconnect/3",
+    "Preferences/Missed Probes Before Reconnect/5",
+    "Preferences/Probe Interval/1 Minute",
+    "Preferences/Probe Interval/2 Minutes",
+    "Preferences/Probe Interval/5 Minutes",
+    "Preferences/Send Rate/Slow (1 line per second)",
+    "Preferences/Send Rate/Normal (2 lines per second)",
+    "Preferences/Send Rate/Fast (5 lines per second)",
     "Help",
     "About",
     "Help/About",
+    "Help/Performance Stats",
+    "Help/Trace Event Loop...",
+    "Performance Stats",
     "Connect To Server",
     "Address",
     "Port",
     "Keep Alive",
+    "Auto Reconnect",
+    "Connecting...",
+    "Highlight Words",
+    "Words (separated by commas)",
+    "Cancel %d/%d",
+    "Stop sending the rest of the paste",
+    "Not Connected",
+    "Save Capture As",
+    "Can't write the capture file",
+    "Open Capture",
+    "Not a capture file",
+    "Replay Finished",
+    "Save Trace As",
+    "Can't write the trace file",
     "Quit",
     "Are You Sure?",
     "Ok",
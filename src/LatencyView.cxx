@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <cstdio>
+
+#include <FL/fl_draw.H>
+#include <FL/Fl_Widget.H>
+
+#include "Chat.H"
+#include "LatencyView.H"
+
+LatencyView::LatencyView(int x, int y, int w, int h)
+: Fl_Widget(x, y, w, h, 0)
+{
+  box(FL_UP_BOX);
+  update();
+}
+
+LatencyView::~LatencyView()
+{
+}
+
+// refresh the tooltip with the bin counts and redraw
+void LatencyView::update()
+{
+  const Chat::LatencyStats *stats = Chat::latencyStats();
+  char text[512];
+  int length = snprintf(text, sizeof(text), "Round trip, last %d probes:",
+                        Chat::LatencyStats::WINDOW);
+
+  for (int i = 0; i < Chat::LatencyStats::BINS; i++)
+  {
+    if (i < Chat::LatencyStats::BINS - 1)
+    {
+      length += snprintf(text + length, sizeof(text) - length,
+                         "\n  < %d ms: %d",
+                         Chat::LatencyStats::bin_limits[i], stats->bins[i]);
+    }
+      else
+    {
+      length += snprintf(text + length, sizeof(text) - length,
+                         "\n  >= %d ms: %d",
+                         Chat::LatencyStats::bin_limits[i - 1], stats->bins[i]);
+    }
+  }
+
+  snprintf(text + length, sizeof(text) - length,
+           "\nMissed probes: %d\nKernel RTT: %.1f ms",
+           stats->missed, stats->kernel_ms);
+
+  copy_tooltip(text);
+  redraw();
+}
+
+void LatencyView::draw()
+{
+  const Chat::LatencyStats *stats = Chat::latencyStats();
+  const int bins = Chat::LatencyStats::BINS;
+  char text[32];
+
+  draw_box();
+
+  if (stats->samples > 0)
+    snprintf(text, sizeof(text), "%.0f ms", stats->last_ms);
+  else
+    snprintf(text, sizeof(text), "-- ms");
+
+  fl_font(FL_HELVETICA, 14);
+  fl_color(FL_FOREGROUND_COLOR);
+  fl_draw(text, x() + 6, y(), 56, h(), FL_ALIGN_LEFT | FL_ALIGN_INSIDE);
+
+  // one bar per bin, scaled to the fullest one
+  int most = 1;
+
+  for (int i = 0; i < bins; i++)
+  {
+    if (stats->bins[i] > most)
+      most = stats->bins[i];
+  }
+
+  const int bar_x = x() + 62;
+  const int bar_w = (w() - 62 - 6) / bins;
+  const int bar_h = h() - 12;
+
+  for (int i = 0; i < bins; i++)
+  {
+    const int height = stats->bins[i] * bar_h / most;
+
+    fl_rectf(bar_x + i * bar_w, y() + 6 + bar_h - height,
+             bar_w - 1, height, FL_INACTIVE_COLOR);
+  }
+}
@@ -0,0 +1,189 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <cstring>
+#include <vector>
+
+#include "LineBuffer.H"
+#include "Scan.H"
+
+namespace
+{
+  // longest line kept whole, anything beyond is passed on in pieces
+  const int max_line = 65536;
+}
+
+LineBuffer::LineBuffer()
+{
+  buf.resize(4096 + 1);
+  start = 0;
+  end = 0;
+  scan = 0;
+  nulls = false;
+}
+
+LineBuffer::~LineBuffer()
+{
+}
+
+// return space for at least size more bytes at the end of the buffer
+char *LineBuffer::reserve(const int size)
+{
+  // move the unfinished line to the front
+  if (start > 0 && (int)buf.size() - end < size + 1)
+  {
+    memmove(buf.data(), buf.data() + start, end - start);
+    end -= start;
+    scan -= start;
+    start = 0;
+  }
+
+  // one extra byte is always kept for the terminating null
+  if ((int)buf.size() - end < size + 1)
+  {
+    size_t new_size = buf.size() * 2;
+
+    while ((int)new_size - end < size + 1)
+      new_size *= 2;
+
+    buf.resize(new_size);
+  }
+
+  return buf.data() + end;
+}
+
+// mark bytes written after reserve() as received
+void LineBuffer::commit(const int size)
+{
+  end += size;
+}
+
+void LineBuffer::append(const char *data, const int size)
+{
+  memcpy(reserve(size), data, size);
+  commit(size);
+}
+
+// return the next complete line (null-terminated in place, without its
+// line ending), or 0 if the rest of the buffer is an unfinished line
+char *LineBuffer::nextLine(int *length)
+{
+  if (start == end)
+  {
+    start = end = scan = 0;
+    nulls = false;
+    return 0;
+  }
+
+  char *line = buf.data() + start;
+  int newline = -1;
+
+  // one pass finds the newline and notes any null bytes on the way
+  while (scan < end)
+  {
+    const int found = Scan::findByte(buf.data() + scan, end - scan, '\n', '\0');
+
+    if (found < 0)
+    {
+      scan = end;
+      break;
+    }
+
+    scan += found;
+
+    if (buf[scan] == '\n')
+    {
+      newline = scan;
+      break;
+    }
+
+    nulls = true;
+    scan++;
+  }
+
+  int size = 0;
+
+  if (newline >= 0)
+  {
+    size = newline - start;
+    start += size + 1;
+  }
+    else
+  {
+    if (end - start < max_line)
+      return 0;
+
+    // too long, hand over what we have
+    size = end - start;
+    start = end;
+  }
+
+  scan = start;
+
+  // strip null bytes, moving the runs between them down
+  int j = size;
+
+  if (nulls == true)
+  {
+    nulls = false;
+    j = 0;
+
+    for (int i = 0; i < size; )
+    {
+      int run = Scan::findByte(line + i, size - i, '\0', '\0');
+
+      if (run < 0)
+        run = size - i;
+
+      memmove(line + j, line + i, run);
+      j += run;
+      i += run + 1;
+    }
+  }
+
+  // servers that end lines with CRLF
+  if (newline >= 0 && j > 0 && line[j - 1] == '\r')
+    j--;
+
+  line[j] = '\0';
+  *length = j;
+
+  return line;
+}
+
+void LineBuffer::clear()
+{
+  start = 0;
+  end = 0;
+  scan = 0;
+  nulls = false;
+}
+
+// bytes waiting for the rest of their line
+int LineBuffer::pending()
+{
+  return end - start;
+}
+
+// bytes allocated, the buffer only grows
+size_t LineBuffer::capacity()
+{
+  return buf.capacity();
+}
@@ -21,21 +21,38 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
 #include "FL/Fl.H"
 
 #include <csignal>
+#include <cstring>
 #include <openssl/ssl.h>
 
+#include "Chat.H"
 #include "Dialog.H"
+#include "EventLoop.H"
+#include "FltkLoop.H"
 #include "Gui.H"
+#include "Headless.H"
 #include "Language.H"
+#include "Tls.H"
 
 #ifndef WIN32
   FL_EXPORT bool fl_disable_wayland = true;
 #endif
 
-int main(/*int argc, char *argv[]*/)
+int main(int argc, char *argv[])
 {
   SSL_load_error_strings();
   OpenSSL_add_ssl_algorithms();
 
+  // nothing on this path opens a display
+  if (argc > 1 && strcmp(argv[1], "--headless") == 0)
+  {
+    SSL_library_init();
+    return Headless::run(argc - 2, argv + 2);
+  }
+
+  FltkLoop fltk_loop;
+
+  EventLoop::use(&fltk_loop);
+
   Fl::scheme("gtk+");
   Fl::screen_scale(0, 1.0);
 
@@ -46,6 +63,9 @@ int main(/*int argc, char *argv[]*/)
   // fltk related inits
   Fl::visual(FL_DOUBLE | FL_RGB);
 
+  // allow Fl::awake() from worker threads
+  Fl::lock();
+
   // program inits
   Language::set(Language::ENGLISH);
 //  Language::set(Language::GERMAN);
@@ -54,10 +74,15 @@ int main(/*int argc, char *argv[]*/)
   SSL_library_init();
   Dialog::init();
   Gui::init();
+  Chat::init();
 
   // delay showing main gui until after all arguments are checked
   Gui::show();
 
-  return Fl::run();
+  const int result = Fl::run();
+
+  Tls::saveCache();
+
+  return result;
 }
 
@@ -0,0 +1,442 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/ssl.h>
+
+#ifdef WIN32
+  #include <winsock2.h>
+#else
+  #include <cerrno>
+  #include <fcntl.h>
+  #include <poll.h>
+  #include <unistd.h>
+  #include <sys/socket.h>
+#endif
+
+#include "EventLoop.H"
+#include "LineBuffer.H"
+#include "NetThread.H"
+#include "SpscRing.H"
+#include "Stats.H"
+#include "Trace.H"
+
+namespace
+{
+  // never destroyed, so exiting while connected doesn't abort
+  std::thread *thread = 0;
+  bool is_running = false;
+
+  std::atomic<bool> stopping{false};
+  std::atomic<bool> closed{false};
+
+  // set while the user interface owes us a delivery, so there is never
+  // more than one EventLoop::awake() outstanding
+  std::atomic<bool> delivery_pending{false};
+
+  // deliveries are spaced at least this far apart
+  const double frame_time = 1.0 / 60;
+
+  int sock = 0;
+  SSL *ssl = 0;
+
+  NetThread::LineCallback *line_callback = 0;
+  NetThread::ClosedCallback *closed_callback = 0;
+
+  // complete lines from the network thread to the user interface
+  SpscRing<std::string, 4096> in_ring;
+
+  // outgoing lines the other way
+  SpscRing<std::string, 1024> out_ring;
+
+  // only touched by the network thread
+  LineBuffer line_buf;
+  std::vector<char> out_buf;
+  size_t out_sent = 0;
+  bool want_write = false;
+
+#ifndef WIN32
+  // wakes the network thread when there is something to send
+  int wake_pipe[2] = { -1, -1 };
+#endif
+
+  bool would_block()
+  {
+#ifdef WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+  }
+
+  void wake_thread()
+  {
+#ifndef WIN32
+    const char c = 0;
+
+    if (::write(wake_pipe[1], &c, 1) < 0)
+    {
+      // pipe already full, the thread is awake anyway
+    }
+#endif
+  }
+
+  void deliver(void *);
+
+  void frame_done(void *)
+  {
+    delivery_pending = false;
+
+    if ((in_ring.empty() == false || closed == true) &&
+        delivery_pending.exchange(true) == false)
+    {
+      deliver(0);
+    }
+  }
+
+  // user interface side, runs from EventLoop::awake(), the thread's
+  // lines are parsed here so the batch counts as the parse stage
+  void deliver(void *)
+  {
+    if (is_running == false)
+      return;
+
+    const Stats::Time started = Stats::start();
+    const Trace::Time traced = Trace::begin();
+    std::string line;
+    int lines = 0;
+
+    // each line carries one spare byte the parser may write into
+    while (in_ring.pop(line) == true)
+    {
+      line_callback(&line[0], line.size() - 1);
+      lines++;
+    }
+
+    Stats::stop(Stats::PARSE, started, lines);
+    Trace::end("deliver", traced, "lines", lines);
+
+    if (closed == true)
+    {
+      closed_callback();
+      return;
+    }
+
+    EventLoop::addTimeout(frame_time, frame_done, 0);
+  }
+
+  void notify()
+  {
+    if (delivery_pending.exchange(true) == false)
+      EventLoop::awake(deliver, 0);
+  }
+
+  // everything below runs on the network thread
+
+  // false when the connection is gone
+  bool read_socket()
+  {
+    while (true)
+    {
+      int size = 0;
+
+      if (ssl)
+      {
+        size = SSL_read(ssl, line_buf.reserve(16384), 16384);
+
+        if (size <= 0)
+        {
+          const int error = SSL_get_error(ssl, size);
+
+          if (error == SSL_ERROR_WANT_READ)
+            return true;
+
+          if (error == SSL_ERROR_WANT_WRITE)
+          {
+            want_write = true;
+            return true;
+          }
+
+          return false;
+        }
+      }
+        else
+      {
+        size = recv(sock, line_buf.reserve(16384), 16384, 0);
+
+        if (size == 0)
+          return false;
+
+        if (size < 0)
+          return would_block();
+      }
+
+      line_buf.commit(size);
+    }
+  }
+
+  bool flush()
+  {
+    want_write = false;
+
+    while (out_sent < out_buf.size())
+    {
+      const int size = out_buf.size() - out_sent;
+      int sent = 0;
+
+      if (ssl)
+      {
+        sent = SSL_write(ssl, out_buf.data() + out_sent, size);
+
+        if (sent <= 0)
+        {
+          const int error = SSL_get_error(ssl, sent);
+
+          if (error == SSL_ERROR_WANT_WRITE)
+          {
+            want_write = true;
+            return true;
+          }
+
+          return error == SSL_ERROR_WANT_READ;
+        }
+      }
+        else
+      {
+        sent = send(sock, out_buf.data() + out_sent, size, 0);
+
+        if (sent < 0)
+        {
+          want_write = would_block();
+          return want_write;
+        }
+      }
+
+      out_sent += sent;
+    }
+
+    out_buf.clear();
+    out_sent = 0;
+
+    return true;
+  }
+
+  // hand over as many complete lines as the ring has room for
+  void pass_lines()
+  {
+    bool passed = false;
+    char *line;
+    int length = 0;
+
+    while (in_ring.full() == false &&
+           (line = line_buf.nextLine(&length)) != 0)
+    {
+      if (length == 0)
+        continue;
+
+      std::string item(line, length + 1);
+
+      in_ring.push(item);
+      passed = true;
+    }
+
+    if (passed == true)
+      notify();
+  }
+
+  void run()
+  {
+    while (stopping == false)
+    {
+      std::string item;
+
+      while (out_ring.pop(item) == true)
+        out_buf.insert(out_buf.end(), item.begin(), item.end());
+
+      if (out_buf.size() > out_sent && flush() == false)
+        break;
+
+      // stop reading while the user interface is behind
+      const bool backlog = in_ring.full();
+
+      short events = backlog ? 0 : POLLIN;
+
+      if (want_write == true)
+        events |= POLLOUT;
+
+      int timeout = -1;
+
+      if (backlog == true)
+        timeout = 5;
+      else if (ssl && SSL_pending(ssl) > 0)
+        timeout = 0;
+
+#ifdef WIN32
+      // no wake pipe here, check the outgoing ring now and then
+      if (timeout < 0 || timeout > 10)
+        timeout = 10;
+
+      WSAPOLLFD fds[1];
+
+      fds[0].fd = sock;
+      fds[0].events = events;
+      fds[0].revents = 0;
+
+      WSAPoll(fds, 1, timeout);
+#else
+      struct pollfd fds[2];
+
+      fds[0].fd = sock;
+      fds[0].events = events;
+      fds[0].revents = 0;
+      fds[1].fd = wake_pipe[0];
+      fds[1].events = POLLIN;
+      fds[1].revents = 0;
+
+      poll(fds, 2, timeout);
+
+      if (fds[1].revents & POLLIN)
+      {
+        char drain[256];
+
+        while (read(wake_pipe[0], drain, sizeof(drain)) > 0)
+        {
+        }
+      }
+#endif
+
+      if (backlog == false &&
+          ((fds[0].revents & (POLLIN | POLLHUP | POLLERR)) ||
+           (ssl && SSL_pending(ssl) > 0) ||
+           (fds[0].revents & POLLOUT)))
+      {
+        if (read_socket() == false)
+          break;
+      }
+
+      pass_lines();
+    }
+
+    if (stopping == false)
+    {
+      pass_lines();
+      closed = true;
+      notify();
+    }
+  }
+}
+
+// take over a connected socket (and its TLS state, if any)
+bool NetThread::start(const int sock_value, SSL *ssl_value,
+                      LineCallback *line_cb, ClosedCallback *closed_cb)
+{
+  if (is_running == true)
+    return false;
+
+#ifndef WIN32
+  if (pipe(wake_pipe) != 0)
+    return false;
+
+  fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+  fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+#endif
+
+  sock = sock_value;
+  ssl = ssl_value;
+  line_callback = line_cb;
+  closed_callback = closed_cb;
+
+  in_ring.clear();
+  out_ring.clear();
+  line_buf.clear();
+  out_buf.clear();
+  out_sent = 0;
+  want_write = false;
+
+  stopping = false;
+  closed = false;
+  delivery_pending = false;
+
+  thread = new std::thread(run);
+  is_running = true;
+
+  return true;
+}
+
+// wait for the thread to let go of the socket, which the caller closes
+void NetThread::stop()
+{
+  if (is_running == false)
+    return;
+
+  stopping = true;
+  wake_thread();
+  thread->join();
+  delete thread;
+  thread = 0;
+
+  is_running = false;
+  EventLoop::removeTimeout(frame_done, 0);
+
+#ifndef WIN32
+  close(wake_pipe[0]);
+  close(wake_pipe[1]);
+#endif
+
+  std::string item;
+
+  while (in_ring.pop(item) == true)
+  {
+  }
+
+  while (out_ring.pop(item) == true)
+  {
+  }
+}
+
+void NetThread::write(const char *message)
+{
+  if (is_running == false)
+    return;
+
+  std::string item(message);
+
+  item += '\n';
+
+  // the thread empties this ring on every pass, so a full one clears fast
+  while (out_ring.push(item) == false)
+  {
+    if (closed == true)
+      return;
+
+    std::this_thread::yield();
+  }
+
+  wake_thread();
+}
+
+bool NetThread::running()
+{
+  return is_running;
+}
@@ -0,0 +1,260 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "NickIndex.H"
+
+namespace
+{
+  unsigned char fold(const char c)
+  {
+    return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : (unsigned char)c;
+  }
+}
+
+NickIndex::NickIndex()
+{
+  clear();
+}
+
+NickIndex::~NickIndex()
+{
+}
+
+// the same nick may be listed on more than one line
+void NickIndex::add(const char *name)
+{
+  const int length = strlen(name);
+  Entry *entry = findEntry(name, length);
+
+  if (entry != 0)
+  {
+    entry->refs++;
+    return;
+  }
+
+  const int node = findNode(name, length, true);
+
+  nodes[node].entries.push_back({ std::string(name, length), 1, 0 });
+}
+
+// nodes left with no nick and nothing below them are cut off on the
+// way back up
+void NickIndex::remove(const char *name)
+{
+  const int length = strlen(name);
+  std::vector<int> path(length + 1, 0);
+
+  for (int i = 0; i < length; i++)
+  {
+    path[i + 1] = findChild(path[i], fold(name[i]));
+
+    if (path[i + 1] < 0)
+      return;
+  }
+
+  std::vector<Entry> &entries = nodes[path[length]].entries;
+  size_t i = 0;
+
+  while (i < entries.size() &&
+         entries[i].name.compare(0, std::string::npos, name, length) != 0)
+  {
+    i++;
+  }
+
+  if (i == entries.size() || --entries[i].refs > 0)
+    return;
+
+  entries.erase(entries.begin() + i);
+
+  for (int depth = length; depth > 0; depth--)
+  {
+    const int node = path[depth];
+
+    if (nodes[node].entries.empty() == false ||
+        nodes[node].children.empty() == false)
+    {
+      break;
+    }
+
+    std::vector<std::pair<unsigned char, int> > &children =
+      nodes[path[depth - 1]].children;
+
+    children.erase(std::lower_bound(children.begin(), children.end(),
+                                    std::make_pair(fold(name[depth - 1]), 0)));
+    free_nodes.push_back(node);
+  }
+}
+
+// mark a nick as having just said something
+void NickIndex::touch(const char *name, const int length)
+{
+  Entry *entry = findEntry(name, length);
+
+  if (entry != 0)
+    entry->active = ++clock;
+}
+
+// every nick starting with prefix (ignoring case), most recently active
+// first, returns how many there are
+int NickIndex::complete(const char *prefix, const int length,
+                        std::vector<std::string> *result)
+{
+  result->clear();
+
+  const int start = findNode(prefix, length, false);
+
+  if (start < 0)
+    return 0;
+
+  std::vector<const Entry *> found;
+  std::vector<int> stack(1, start);
+
+  while (stack.empty() == false)
+  {
+    const Node &node = nodes[stack.back()];
+
+    stack.pop_back();
+
+    for (const Entry &entry : node.entries)
+      found.push_back(&entry);
+
+    for (const auto &child : node.children)
+      stack.push_back(child.second);
+  }
+
+  std::sort(found.begin(), found.end(),
+    [](const Entry *a, const Entry *b)
+    {
+      if (a->active != b->active)
+        return a->active > b->active;
+
+      return a->name < b->name;
+    });
+
+  for (const Entry *entry : found)
+    result->push_back(entry->name);
+
+  return result->size();
+}
+
+void NickIndex::clear()
+{
+  nodes.clear();
+  nodes.resize(1);
+  free_nodes.clear();
+  clock = 0;
+}
+
+// approximate heap use of the trie, names short enough for the small
+// string buffer cost nothing extra
+size_t NickIndex::memoryUsed()
+{
+  size_t bytes = nodes.capacity() * sizeof(Node);
+
+  for (const Node &node : nodes)
+  {
+    bytes += node.children.capacity() * sizeof(node.children[0]) +
+             node.entries.capacity() * sizeof(Entry);
+
+    for (const Entry &entry : node.entries)
+    {
+      if (entry.name.capacity() > 15)
+        bytes += entry.name.capacity() + 1;
+    }
+  }
+
+  return bytes;
+}
+
+// child of node for the folded character c, or -1
+int NickIndex::findChild(const int node, const unsigned char c)
+{
+  const std::vector<std::pair<unsigned char, int> > &children =
+    nodes[node].children;
+  const auto it = std::lower_bound(children.begin(), children.end(),
+                                   std::make_pair(c, 0));
+
+  return (it != children.end() && it->first == c) ? it->second : -1;
+}
+
+// follow the folded key down from the root, optionally growing the trie
+int NickIndex::findNode(const char *key, const int length, const bool create)
+{
+  int node = 0;
+
+  for (int i = 0; i < length; i++)
+  {
+    const unsigned char c = fold(key[i]);
+    const int found = findChild(node, c);
+
+    if (found >= 0)
+    {
+      node = found;
+      continue;
+    }
+
+    if (create == false)
+      return -1;
+
+    int child;
+
+    if (free_nodes.empty() == false)
+    {
+      child = free_nodes.back();
+      free_nodes.pop_back();
+    }
+      else
+    {
+      child = nodes.size();
+      nodes.emplace_back();
+    }
+
+    std::vector<std::pair<unsigned char, int> > &children = nodes[node].children;
+
+    children.insert(std::lower_bound(children.begin(), children.end(),
+                                     std::make_pair(c, 0)),
+                    std::make_pair(c, child));
+    node = child;
+  }
+
+  return node;
+}
+
+NickIndex::Entry *NickIndex::findEntry(const char *name, const int length)
+{
+  const int node = findNode(name, length, false);
+
+  if (node < 0)
+    return 0;
+
+  for (Entry &entry : nodes[node].entries)
+  {
+    if (entry.name.compare(0, std::string::npos, name, length) == 0)
+      return &entry;
+  }
+
+  return 0;
+}
@@ -0,0 +1,231 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <array>
+#include <cstring>
+
+#include "Parser.H"
+#include "Scan.H"
+
+namespace
+{
+  enum
+  {
+    CLASS_URL_STOP = 1,
+    CLASS_DIGIT = 2
+  };
+
+  constexpr std::array<unsigned char, 256> make_classes()
+  {
+    std::array<unsigned char, 256> table{};
+
+    // characters that can't be part of a url
+    for (int i = 0; i < 32; i++)
+      table[i] |= CLASS_URL_STOP;
+
+    const char url_stops[] = " \"<>{}|\\^`";
+
+    for (int i = 0; url_stops[i] != '\0'; i++)
+      table[(unsigned char)url_stops[i]] |= CLASS_URL_STOP;
+
+    table[127] |= CLASS_URL_STOP;
+
+    for (int i = '0'; i <= '9'; i++)
+      table[i] |= CLASS_DIGIT;
+
+    return table;
+  }
+
+  constexpr std::array<unsigned char, 256> classes = make_classes();
+
+  // event type from the first byte of a line
+  constexpr std::array<unsigned char, 256> make_line_types()
+  {
+    std::array<unsigned char, 256> table{};
+
+    for (int i = 0; i < 256; i++)
+      table[i] = Event::TEXT;
+
+    table['['] = Event::CHAT;
+    table['<'] = Event::PM;
+    table['('] = Event::NOTICE;
+    table['>'] = Event::CLIENT;
+    table['@'] = Event::LIST;
+    table['+'] = Event::JOIN;
+    table['-'] = Event::LEAVE;
+
+    return table;
+  }
+
+  constexpr std::array<unsigned char, 256> line_types = make_line_types();
+
+  // byte that ends the nick, for each event type that has one
+  constexpr char nick_ends[Event::TYPE_COUNT] =
+  {
+    0, ']', ':', ' ', 0, 0, 0, 0, 0
+  };
+
+  // +[N]name and -[N]
+  bool scan_user(const char *text, const int length, Event *event)
+  {
+    int id = 0;
+    int i = 2;
+
+    if (length < 2 || text[1] != '[')
+      return false;
+
+    while (i < length && i < 10 && (classes[(unsigned char)text[i]] & CLASS_DIGIT))
+    {
+      id = id * 10 + text[i] - '0';
+      i++;
+    }
+
+    if (i == 2 || i >= length || text[i] != ']')
+      return false;
+
+    event->id = id;
+    event->nick.start = i + 1;
+    event->nick.length = length - (i + 1);
+    event->message.start = length;
+    event->message.length = 0;
+
+    return true;
+  }
+
+  void add_url(Event *events, int *count, const int start, const int length)
+  {
+    Event *url = events + *count;
+
+    *url = events[0];
+    url->type = Event::URL;
+    url->message.start = start;
+    url->message.length = length;
+    (*count)++;
+  }
+}
+
+// fills events with the line itself followed by one event per url,
+// returns how many there are
+int Parser::scan(const char *text, const int length, Event *events)
+{
+  Event *event = events;
+  int count = 1;
+
+  event->type = Event::TEXT;
+  event->id = -1;
+  event->line = text;
+  event->length = length;
+  event->nick.start = 0;
+  event->nick.length = 0;
+  event->message.start = 0;
+  event->message.length = length;
+
+  if (length <= 0)
+    return count;
+
+  event->type = line_types[(unsigned char)text[0]];
+
+  switch (event->type)
+  {
+    case Event::LIST:
+      return count;
+    case Event::JOIN:
+    case Event::LEAVE:
+      if (scan_user(text, length, event))
+        return count;
+
+      event->type = Event::TEXT;
+      break;
+  }
+
+  const char nick_end = nick_ends[event->type];
+  int i = 0;
+
+  if (nick_end != 0)
+  {
+    const int found = Scan::findByte(text + 1, length - 1, nick_end, nick_end);
+
+    event->nick.start = 1;
+    event->message.start = length;
+
+    if (found >= 0)
+    {
+      event->nick.length = found;
+      i = found + 2;
+
+      if (event->type == Event::CHAT)
+      {
+        // "[nick]: message"
+        int j = i;
+
+        if (j < length && text[j] == ':')
+          j++;
+
+        if (j < length && text[j] == ' ')
+          j++;
+
+        event->message.start = j;
+      }
+      else if (event->type == Event::PM)
+      {
+        event->message.start = i;
+      }
+        else
+      {
+        // "(nick ... using client)"
+        const int using_start = Scan::find(text + i, length - i, "using", 5);
+
+        if (using_start >= 0)
+          event->message.start = i + using_start + 5;
+      }
+    }
+  }
+
+  event->message.length = length - event->message.start;
+
+  // jump from one "http" to the next
+  while (i < length && count < MAX_EVENTS)
+  {
+    const int found = Scan::find(text + i, length - i, "http", 4);
+
+    if (found < 0)
+      break;
+
+    const int url_start = i + found;
+
+    i = url_start + 4;
+
+    if (i < length && text[i] == 's')
+      i++;
+
+    if (length - i < 3 || memcmp(text + i, "://", 3) != 0)
+      continue;
+
+    i += 3;
+
+    // stop at first non-url character
+    while (i < length && (classes[(unsigned char)text[i]] & CLASS_URL_STOP) == 0)
+      i++;
+
+    add_url(events, &count, url_start, i - url_start);
+  }
+
+  return count;
+}
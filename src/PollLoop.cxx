@@ -0,0 +1,301 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#ifdef WIN32
+  #include <winsock2.h>
+  #define poll WSAPoll
+#else
+  #include <fcntl.h>
+  #include <poll.h>
+  #include <unistd.h>
+#endif
+
+#include "PollLoop.H"
+
+PollLoop::PollLoop()
+: next_order(0),
+  in_timeout(false)
+{
+  wake_pipe[0] = -1;
+  wake_pipe[1] = -1;
+
+#ifndef WIN32
+  if (pipe(wake_pipe) == 0)
+  {
+    fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+  }
+#endif
+}
+
+PollLoop::~PollLoop()
+{
+#ifndef WIN32
+  if (wake_pipe[0] != -1)
+  {
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+  }
+#endif
+}
+
+// a new handler takes over the events it asks for, like Fl::add_fd()
+void PollLoop::addFd(const int fd, const int when,
+                     EventLoop::FdHandler *handler, void *data)
+{
+  removeFd(fd, when);
+  watches.push_back({ fd, when, handler, data });
+}
+
+void PollLoop::removeFd(const int fd, const int when)
+{
+  for (size_t i = 0; i < watches.size(); )
+  {
+    if (watches[i].fd == fd)
+      watches[i].when &= ~when;
+
+    if (watches[i].when == 0)
+    {
+      watches.erase(watches.begin() + i);
+      continue;
+    }
+
+    i++;
+  }
+}
+
+void PollLoop::addTimeout(const double seconds,
+                          EventLoop::TimeoutHandler *handler, void *data)
+{
+  const Time due = std::chrono::steady_clock::now() +
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(seconds));
+
+  timers.push_back({ due, next_order++, handler, data });
+}
+
+// counting from when the running timeout was due keeps a steady beat
+void PollLoop::repeatTimeout(const double seconds,
+                             EventLoop::TimeoutHandler *handler, void *data)
+{
+  if (in_timeout == false)
+  {
+    addTimeout(seconds, handler, data);
+    return;
+  }
+
+  const Time due = running_due +
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(seconds));
+
+  timers.push_back({ due, next_order++, handler, data });
+}
+
+// a null data pointer matches any, as with Fl::remove_timeout()
+void PollLoop::removeTimeout(EventLoop::TimeoutHandler *handler, void *data)
+{
+  timers.erase(std::remove_if(timers.begin(), timers.end(),
+                              [handler, data](const Timer &timer)
+                              {
+                                return timer.handler == handler &&
+                                       (data == 0 || timer.data == data);
+                              }),
+               timers.end());
+}
+
+int PollLoop::awake(EventLoop::TimeoutHandler *handler, void *data)
+{
+  {
+    std::lock_guard<std::mutex> lock(awake_lock);
+
+    awakes.push_back({ handler, data });
+  }
+
+#ifndef WIN32
+  const char byte = 0;
+
+  if (write(wake_pipe[1], &byte, 1) < 0)
+  {
+    // the pipe is full, poll() is about to return anyway
+  }
+#endif
+
+  return 0;
+}
+
+// handlers may add and remove watches, only ones still there are run
+bool PollLoop::watching(const Watch &watch)
+{
+  for (const Watch &item : watches)
+  {
+    if (item.fd == watch.fd && item.handler == watch.handler &&
+        item.data == watch.data && (item.when & watch.when) != 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void PollLoop::runFds(const double seconds)
+{
+  std::vector<struct pollfd> fds;
+  std::vector<Watch> ready;
+
+  for (const Watch &watch : watches)
+  {
+    struct pollfd item;
+
+    item.fd = watch.fd;
+    item.events = ((watch.when & EventLoop::READ) ? POLLIN : 0) |
+                  ((watch.when & EventLoop::WRITE) ? POLLOUT : 0) |
+                  ((watch.when & EventLoop::EXCEPT) ? POLLPRI : 0);
+    item.revents = 0;
+    fds.push_back(item);
+  }
+
+#ifndef WIN32
+  fds.push_back({ wake_pipe[0], POLLIN, 0 });
+#endif
+
+#ifdef WIN32
+  // nothing can interrupt the wait, so keep it short
+  const int ms = seconds < 0.1 ? seconds * 1000 : 100;
+#else
+  const int ms = seconds * 1000 + 0.999;
+#endif
+
+  if (poll(fds.data(), fds.size(), ms) <= 0)
+    return;
+
+  // errors and hangups wake up readers and writers so they find out
+  for (size_t i = 0; i < watches.size(); i++)
+  {
+    const short revents = fds[i].revents;
+    const short fail = POLLERR | POLLHUP | POLLNVAL;
+    int when = 0;
+
+    if (revents & (POLLIN | fail))
+      when |= EventLoop::READ;
+
+    if (revents & (POLLOUT | fail))
+      when |= EventLoop::WRITE;
+
+    if (revents & (POLLPRI | fail))
+      when |= EventLoop::EXCEPT;
+
+    if ((when & watches[i].when) != 0)
+      ready.push_back({ watches[i].fd, when & watches[i].when,
+                        watches[i].handler, watches[i].data });
+  }
+
+  for (const Watch &watch : ready)
+  {
+    if (watching(watch) == true)
+      watch.handler(watch.fd, watch.data);
+  }
+}
+
+void PollLoop::runAwakes()
+{
+  std::vector<Call> calls;
+
+  {
+    std::lock_guard<std::mutex> lock(awake_lock);
+
+    calls.swap(awakes);
+  }
+
+#ifndef WIN32
+  char bytes[256];
+
+  while (read(wake_pipe[0], bytes, sizeof(bytes)) > 0)
+  {
+  }
+#endif
+
+  for (const Call &call : calls)
+    call.handler(call.data);
+}
+
+// timeouts added while these run wait for the next pass
+void PollLoop::runTimers()
+{
+  const Time now = std::chrono::steady_clock::now();
+  const unsigned long last = next_order;
+
+  while (true)
+  {
+    int found = -1;
+
+    for (size_t i = 0; i < timers.size(); i++)
+    {
+      if (timers[i].due <= now && timers[i].order < last &&
+          (found == -1 || timers[i].due < timers[found].due))
+      {
+        found = i;
+      }
+    }
+
+    if (found == -1)
+      break;
+
+    const Timer timer = timers[found];
+
+    timers.erase(timers.begin() + found);
+
+    running_due = timer.due;
+    in_timeout = true;
+    timer.handler(timer.data);
+    in_timeout = false;
+  }
+}
+
+// one pass, waits at most seconds for something to happen
+void PollLoop::wait(const double seconds)
+{
+  double limit = seconds;
+  const Time now = std::chrono::steady_clock::now();
+
+  for (const Timer &timer : timers)
+  {
+    const std::chrono::duration<double> left = timer.due - now;
+
+    if (left.count() < limit)
+      limit = left.count() > 0 ? left.count() : 0;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(awake_lock);
+
+    if (awakes.empty() == false)
+      limit = 0;
+  }
+
+  runFds(limit);
+  runAwakes();
+  runTimers();
+}
@@ -0,0 +1,284 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Capture.H"
+#include "EventLoop.H"
+#include "Replay.H"
+#include "Session.H"
+
+namespace
+{
+  // most bytes fed per callback, so the panes get redrawn and the
+  // other sessions get a turn while replaying as fast as possible
+  const int batch_bytes = 256 * 1024;
+
+  struct record
+  {
+    double time;
+    int stream;
+    size_t start;
+    int size;
+  };
+
+  // the whole capture is loaded up front, reading it mustn't count
+  // against the replay
+  std::vector<char> data;
+  std::vector<record> records;
+  size_t next = 0;
+
+  std::string name;
+  double speed = 1;
+  bool playing = false;
+
+  // by stream number, a closed session leaves a hole
+  std::vector<Session *> sessions;
+  std::vector<bool> opened;
+
+  Replay::OpenHandler *open_handler = 0;
+  Replay::DoneHandler *done_handler = 0;
+
+  std::chrono::steady_clock::time_point start_time;
+
+  // time spent inside the sessions, apart from waiting and redraws
+  std::chrono::steady_clock::duration busy_time;
+  unsigned long bytes = 0;
+
+  bool get_varint(size_t *pos, unsigned long *value)
+  {
+    *value = 0;
+
+    for (int shift = 0; shift < 64 && *pos < data.size(); shift += 7)
+    {
+      const unsigned char c = data[(*pos)++];
+
+      *value |= (unsigned long)(c & 0x7f) << shift;
+
+      if ((c & 0x80) == 0)
+        return true;
+    }
+
+    return false;
+  }
+
+  // a record cut short by a crash ends the capture early
+  bool load(const char *path)
+  {
+    FILE *in = fopen(path, "rb");
+
+    if (in == 0)
+      return false;
+
+    char buf[65536];
+    size_t size;
+
+    data.clear();
+
+    while ((size = fread(buf, 1, sizeof(buf), in)) > 0)
+      data.insert(data.end(), buf, buf + size);
+
+    fclose(in);
+
+    if (data.size() < 5 || memcmp(&data[0], "JCAP", 4) != 0 ||
+        data[4] != Capture::VERSION)
+    {
+      data.clear();
+      return false;
+    }
+
+    records.clear();
+
+    size_t pos = 5;
+    double time = 0;
+    unsigned long delta, stream, length;
+
+    while (get_varint(&pos, &delta) && get_varint(&pos, &stream) &&
+           get_varint(&pos, &length) && length <= data.size() - pos)
+    {
+      time += delta / 1000000.0;
+      records.push_back({ time, (int)stream, pos, (int)length });
+      pos += length;
+    }
+
+    return true;
+  }
+
+  const char *base_name(const char *path)
+  {
+    const char *slash = strrchr(path, '/');
+
+#ifdef WIN32
+    const char *backslash = strrchr(path, '\\');
+
+    if (backslash > slash)
+      slash = backslash;
+#endif
+
+    return slash ? slash + 1 : path;
+  }
+
+  Session *session_for(const int stream)
+  {
+    if (stream >= (int)sessions.size())
+    {
+      sessions.resize(stream + 1, 0);
+      opened.resize(stream + 1, false);
+    }
+
+    if (opened[stream] == false)
+    {
+      opened[stream] = true;
+      sessions[stream] = open_handler(stream);
+
+      if (sessions[stream])
+        sessions[stream]->startReplay(name.c_str(), stream);
+    }
+
+    return sessions[stream];
+  }
+
+  void finish()
+  {
+    const std::chrono::duration<double> total =
+      std::chrono::steady_clock::now() - start_time;
+    const std::chrono::duration<double> busy = busy_time;
+    const double span = records.empty() ? 0 : records.back().time;
+    char text[256];
+
+    snprintf(text, sizeof(text),
+             "Replayed %lu bytes in %lu reads\n"
+             "%.1f s of traffic in %.1f s\n"
+             "%.1f s handling (%.1f MB/s)",
+             bytes, (unsigned long)records.size(), span, total.count(),
+             busy.count(), busy.count() > 0 ?
+               bytes / busy.count() / 1000000.0 : 0.0);
+
+    Replay::stop();
+
+    if (done_handler)
+      done_handler(text);
+  }
+
+  // feed whatever is due, then wait for the next record
+  void step(void *)
+  {
+    const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_time;
+    const double now = elapsed.count() * speed;
+    int batch = 0;
+
+    while (next < records.size() && batch < batch_bytes)
+    {
+      const record *r = &records[next];
+
+      if (speed > 0 && r->time > now)
+        break;
+
+      Session *session = session_for(r->stream);
+
+      if (session)
+      {
+        const std::chrono::steady_clock::time_point before =
+          std::chrono::steady_clock::now();
+
+        session->feed(&data[r->start], r->size);
+        busy_time += std::chrono::steady_clock::now() - before;
+        bytes += r->size;
+      }
+
+      batch += r->size;
+      next++;
+    }
+
+    if (next >= records.size())
+    {
+      finish();
+      return;
+    }
+
+    double delay = 0;
+
+    if (speed > 0 && batch < batch_bytes)
+      delay = (records[next].time - now) / speed;
+
+    EventLoop::addTimeout(delay > 0 ? delay : 0.0, step, 0);
+  }
+}
+
+// false if the file can't be read or isn't a capture, a replay already
+// going is stopped first
+bool Replay::start(const char *path, const double speed_value,
+                   OpenHandler *open, DoneHandler *done)
+{
+  stop();
+
+  if (load(path) == false)
+    return false;
+
+  name = base_name(path);
+  speed = speed_value;
+  open_handler = open;
+  done_handler = done;
+  next = 0;
+  bytes = 0;
+  busy_time = std::chrono::steady_clock::duration::zero();
+  start_time = std::chrono::steady_clock::now();
+  playing = true;
+
+  EventLoop::addTimeout(0.0, step, 0);
+
+  return true;
+}
+
+// the sessions stay as they are
+void Replay::stop()
+{
+  if (playing == false)
+    return;
+
+  EventLoop::removeTimeout(step, 0);
+  playing = false;
+  sessions.clear();
+  opened.clear();
+  data.clear();
+  data.shrink_to_fit();
+  records.clear();
+  records.shrink_to_fit();
+}
+
+// the session is going away, its stream is skipped from here on
+void Replay::drop(Session *session)
+{
+  for (size_t i = 0; i < sessions.size(); i++)
+  {
+    if (sessions[i] == session)
+      sessions[i] = 0;
+  }
+}
+
+bool Replay::running()
+{
+  return playing;
+}
@@ -0,0 +1,314 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+  #define SCAN_X86
+  #include <immintrin.h>
+#endif
+
+#include "Scan.H"
+
+namespace
+{
+  int find_byte_scalar(const char *text, const int length,
+                       const char a, const char b)
+  {
+    for (int i = 0; i < length; i++)
+    {
+      if (text[i] == a || text[i] == b)
+        return i;
+    }
+
+    return -1;
+  }
+
+  int find_scalar(const char *text, const int length,
+                  const char *word, const int word_length)
+  {
+    for (int i = 0; i + word_length <= length; i++)
+    {
+      if (text[i] == word[0] && memcmp(text + i, word, word_length) == 0)
+        return i;
+    }
+
+    return -1;
+  }
+
+  int ascii_run_scalar(const char *text, const int length)
+  {
+    for (int i = 0; i < length; i++)
+    {
+      if ((unsigned char)text[i] >= 0x80)
+        return i;
+    }
+
+    return length;
+  }
+
+#ifdef SCAN_X86
+  // 16 bytes per step
+  __attribute__((target("sse2")))
+  int find_byte_sse2(const char *text, const int length,
+                     const char a, const char b)
+  {
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    int i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+      const __m128i v = _mm_loadu_si128((const __m128i *)(text + i));
+      const int mask = _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+
+      if (mask != 0)
+        return i + __builtin_ctz(mask);
+    }
+
+    const int rest = find_byte_scalar(text + i, length - i, a, b);
+
+    return rest < 0 ? -1 : i + rest;
+  }
+
+  // compare the first and last byte of the word at every offset at once,
+  // only candidates matching both are checked in full
+  __attribute__((target("sse2")))
+  int find_sse2(const char *text, const int length,
+                const char *word, const int word_length)
+  {
+    if (word_length < 2)
+      return word_length == 1 ? find_byte_sse2(text, length, word[0], word[0]) : 0;
+
+    const __m128i first = _mm_set1_epi8(word[0]);
+    const __m128i last = _mm_set1_epi8(word[word_length - 1]);
+    int i = 0;
+
+    for (; i + word_length - 1 + 16 <= length; i += 16)
+    {
+      const __m128i v1 = _mm_loadu_si128((const __m128i *)(text + i));
+      const __m128i v2 =
+        _mm_loadu_si128((const __m128i *)(text + i + word_length - 1));
+      int mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(v1, first), _mm_cmpeq_epi8(v2, last)));
+
+      while (mask != 0)
+      {
+        const int bit = __builtin_ctz(mask);
+
+        if (memcmp(text + i + bit + 1, word + 1, word_length - 2) == 0)
+          return i + bit;
+
+        mask &= mask - 1;
+      }
+    }
+
+    const int rest = find_scalar(text + i, length - i, word, word_length);
+
+    return rest < 0 ? -1 : i + rest;
+  }
+
+  __attribute__((target("sse2")))
+  int ascii_run_sse2(const char *text, const int length)
+  {
+    int i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+      const __m128i v = _mm_loadu_si128((const __m128i *)(text + i));
+      const int mask = _mm_movemask_epi8(v);
+
+      if (mask != 0)
+        return i + __builtin_ctz(mask);
+    }
+
+    return i + ascii_run_scalar(text + i, length - i);
+  }
+
+  // 32 bytes per step
+  __attribute__((target("avx2")))
+  int find_byte_avx2(const char *text, const int length,
+                     const char a, const char b)
+  {
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    int i = 0;
+
+    for (; i + 32 <= length; i += 32)
+    {
+      const __m256i v = _mm256_loadu_si256((const __m256i *)(text + i));
+      const unsigned int mask = _mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)));
+
+      if (mask != 0)
+        return i + __builtin_ctz(mask);
+    }
+
+    const int rest = find_byte_sse2(text + i, length - i, a, b);
+
+    return rest < 0 ? -1 : i + rest;
+  }
+
+  __attribute__((target("avx2")))
+  int find_avx2(const char *text, const int length,
+                const char *word, const int word_length)
+  {
+    if (word_length < 2)
+      return word_length == 1 ? find_byte_avx2(text, length, word[0], word[0]) : 0;
+
+    const __m256i first = _mm256_set1_epi8(word[0]);
+    const __m256i last = _mm256_set1_epi8(word[word_length - 1]);
+    int i = 0;
+
+    for (; i + word_length - 1 + 32 <= length; i += 32)
+    {
+      const __m256i v1 = _mm256_loadu_si256((const __m256i *)(text + i));
+      const __m256i v2 =
+        _mm256_loadu_si256((const __m256i *)(text + i + word_length - 1));
+      unsigned int mask = _mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(v1, first),
+                         _mm256_cmpeq_epi8(v2, last)));
+
+      while (mask != 0)
+      {
+        const int bit = __builtin_ctz(mask);
+
+        if (memcmp(text + i + bit + 1, word + 1, word_length - 2) == 0)
+          return i + bit;
+
+        mask &= mask - 1;
+      }
+    }
+
+    const int rest = find_sse2(text + i, length - i, word, word_length);
+
+    return rest < 0 ? -1 : i + rest;
+  }
+
+  __attribute__((target("avx2")))
+  int ascii_run_avx2(const char *text, const int length)
+  {
+    int i = 0;
+
+    for (; i + 32 <= length; i += 32)
+    {
+      const __m256i v = _mm256_loadu_si256((const __m256i *)(text + i));
+      const unsigned int mask = _mm256_movemask_epi8(v);
+
+      if (mask != 0)
+        return i + __builtin_ctz(mask);
+    }
+
+    return i + ascii_run_sse2(text + i, length - i);
+  }
+#endif
+
+  struct Kernels
+  {
+    int (*find_byte)(const char *, const int, const char, const char);
+    int (*find)(const char *, const int, const char *, const int);
+    int (*ascii_run)(const char *, const int);
+    const char *name;
+  };
+
+  const Kernels kernels[] =
+  {
+    { find_byte_scalar, find_scalar, ascii_run_scalar, "scalar" },
+#ifdef SCAN_X86
+    { find_byte_sse2, find_sse2, ascii_run_sse2, "sse2" },
+    { find_byte_avx2, find_avx2, ascii_run_avx2, "avx2" }
+#endif
+  };
+
+  bool supported(const int kernel)
+  {
+    switch (kernel)
+    {
+      case Scan::KERNEL_SCALAR:
+        return true;
+#ifdef SCAN_X86
+      case Scan::KERNEL_SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+      case Scan::KERNEL_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+      default:
+        return false;
+    }
+  }
+
+  // best kernel this cpu runs, picked once at startup
+  int pick_kernel()
+  {
+    for (int i = Scan::KERNEL_AVX2; i > Scan::KERNEL_SCALAR; i--)
+    {
+      if (supported(i))
+        return i;
+    }
+
+    return Scan::KERNEL_SCALAR;
+  }
+
+  int current = pick_kernel();
+}
+
+// offset of the first byte equal to a or b, or -1
+int Scan::findByte(const char *text, const int length,
+                   const char a, const char b)
+{
+  return kernels[current].find_byte(text, length, a, b);
+}
+
+// offset of the first occurrence of word, or -1
+int Scan::find(const char *text, const int length,
+               const char *word, const int word_length)
+{
+  return kernels[current].find(text, length, word, word_length);
+}
+
+// number of leading bytes below 0x80
+int Scan::asciiRun(const char *text, const int length)
+{
+  return kernels[current].ascii_run(text, length);
+}
+
+// switch kernels, fails if the cpu can't run the one asked for
+bool Scan::setKernel(const int kernel)
+{
+  if (supported(kernel) == false)
+    return false;
+
+  current = kernel;
+
+  return true;
+}
+
+int Scan::kernel()
+{
+  return current;
+}
+
+const char *Scan::kernelName()
+{
+  return kernels[current].name;
+}
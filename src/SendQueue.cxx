@@ -0,0 +1,157 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <chrono>
+#include <deque>
+#include <string>
+
+#include "EventLoop.H"
+#include "SendQueue.H"
+#include "Session.H"
+
+SendQueue::SendQueue(Session *owner)
+{
+  session = owner;
+  total = 0;
+  sent = 0;
+  rate = 2;
+  burst = 5;
+  tokens = 5;
+  last_refill = std::chrono::steady_clock::now();
+}
+
+SendQueue::~SendQueue()
+{
+  EventLoop::removeTimeout(drainTimeout, this);
+}
+
+// split text into lines and queue them, empty lines are dropped
+void SendQueue::send(const char *text)
+{
+  const char *start = text;
+
+  while (true)
+  {
+    const char *end = start;
+
+    while (*end != '\0' && *end != '\n' && *end != '\r')
+      end++;
+
+    if (end > start)
+    {
+      lines.push_back(std::string(start, end - start));
+      total++;
+    }
+
+    if (*end == '\0')
+      break;
+
+    start = end + 1;
+  }
+
+  EventLoop::removeTimeout(drainTimeout, this);
+  drain();
+}
+
+// drop whatever hasn't been sent yet
+void SendQueue::cancel()
+{
+  EventLoop::removeTimeout(drainTimeout, this);
+  lines.clear();
+  total = 0;
+  sent = 0;
+  showProgress();
+}
+
+void SendQueue::setRate(const double lines_per_second, const int max_burst)
+{
+  refill();
+  rate = lines_per_second;
+  burst = max_burst;
+
+  if (tokens > burst)
+    tokens = burst;
+
+  if (lines.empty() == false)
+  {
+    EventLoop::removeTimeout(drainTimeout, this);
+    drain();
+  }
+}
+
+// a total of zero means nothing is queued
+void SendQueue::showProgress()
+{
+  session->sendProgress(sent, total);
+}
+
+int SendQueue::pending()
+{
+  return lines.size();
+}
+
+void SendQueue::refill()
+{
+  const std::chrono::steady_clock::time_point now =
+    std::chrono::steady_clock::now();
+  const std::chrono::duration<double> elapsed = now - last_refill;
+
+  tokens += elapsed.count() * rate;
+
+  if (tokens > burst)
+    tokens = burst;
+
+  last_refill = now;
+}
+
+// send as many lines as the bucket allows, then wait for the next token,
+// lines queued before the connection was lost are dropped
+void SendQueue::drain()
+{
+  refill();
+
+  while (lines.empty() == false && tokens >= 1)
+  {
+    if (session->isConnected() == true)
+    {
+      session->write(lines.front().c_str());
+      tokens -= 1;
+    }
+
+    lines.pop_front();
+    sent++;
+  }
+
+  if (lines.empty() == true)
+  {
+    total = 0;
+    sent = 0;
+    showProgress();
+    return;
+  }
+
+  showProgress();
+  EventLoop::addTimeout((1 - tokens) / rate, drainTimeout, this);
+}
+
+void SendQueue::drainTimeout(void *data)
+{
+  ((SendQueue *)data)->drain();
+}
@@ -0,0 +1,1530 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/ssl.h>
+
+#ifdef WIN32
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
+#else
+  #include <cerrno>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <arpa/inet.h>
+  #include <netinet/in.h>
+  #include <netinet/tcp.h>
+  #include <sys/socket.h>
+  #include <netdb.h>
+#endif
+
+#include "Capture.H"
+#include "EventLoop.H"
+#include "Highlight.H"
+#include "NetThread.H"
+#include "Parser.H"
+#include "Session.H"
+#include "Stats.H"
+#include "Tls.H"
+#include "Trace.H"
+
+namespace
+{
+#ifdef WIN32
+  WSADATA wsa_data;
+#endif
+
+  // head start each address gets before the next one is tried (RFC 8305)
+  const double attempt_delay = 0.25;
+
+  // most bytes taken from the socket per wakeup, so a flood can't starve
+  // the user interface or the other sessions
+  const int read_budget = 256 * 1024;
+
+  // seconds allowed for connect and handshake together
+  const double connect_timeout = 10;
+
+  // seconds between reconnects, doubled after every failure
+  const double reconnect_min = 1;
+  const double reconnect_max = 60;
+
+  std::minstd_rand jitter(std::random_device{}());
+
+  // after a reconnect, users not listed again within this many seconds
+  // of the last +[ line are dropped
+  const double resync_quiet = 2;
+
+  // Naken Chat has no ping, .Z is the one command every server answers,
+  // its reply is the whole user list so it only proves the link is up
+  const char probe_command[] = ".Z";
+
+  // sessions that still exist, a lookup may finish after its session
+  // is gone
+  std::vector<Session *> live;
+
+  // lookup numbers are never reused, even by a new session that gets
+  // an old one's address
+  int next_generation = 0;
+
+  struct resolve_result
+  {
+    EventLoop::TimeoutHandler *done;
+    Session *session;
+    int generation;
+    int error;
+    struct addrinfo *list;
+  };
+
+  // there is only one NetThread, the first threaded session gets it
+  Session *thread_session = 0;
+
+  SessionView quiet_view;
+  SessionView *view = &quiet_view;
+
+  bool would_block()
+  {
+#ifdef WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+  }
+
+  bool in_progress()
+  {
+#ifdef WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EINPROGRESS;
+#endif
+  }
+
+  void close_fd(const int fd)
+  {
+    EventLoop::removeFd(fd);
+
+#ifdef WIN32
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+  }
+
+  bool set_non_blocking(const int fd)
+  {
+#ifdef WIN32
+    unsigned long int mode = 1;
+
+    return ioctlsocket(fd, FIONBIO, &mode) == NO_ERROR;
+#else
+    return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != -1;
+#endif
+  }
+
+  // runs on its own thread, getaddrinfo() can take seconds
+  void resolve(const std::string address, const std::string service,
+               resolve_result *result)
+  {
+    struct addrinfo hints;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    result->list = 0;
+    result->error = getaddrinfo(address.c_str(), service.c_str(),
+                                &hints, &result->list);
+
+    if (EventLoop::awake(result->done, result) != 0)
+    {
+      if (result->list)
+        freeaddrinfo(result->list);
+
+      delete result;
+    }
+  }
+}
+
+Session::Session()
+: sock(0),
+  connect_state(STATE_IDLE),
+  ip_info(0),
+  next_address(0),
+  resolve_generation(-1),
+  ssl(0),
+  server_port(0),
+  out_sent(0),
+  flush_after_read(false),
+  connected(false),
+  enable_ssl(false),
+  keep_alive(false),
+  auto_reconnect(false),
+  threaded(false),
+  reconnecting(false),
+  reconnect_pending(false),
+  reconnect_delay(reconnect_min),
+  resync(false),
+  probe_limit(3),
+  probe_interval(120),
+  probe_pending(false),
+  missed_probes(0),
+  latency_next(0),
+  send_queue(this)
+{
+  event_bus.subscribe(1u << Event::JOIN | 1u << Event::LEAVE,
+                      userEvents, this);
+  event_bus.subscribe(1u << Event::CHAT, chatEvents, this);
+
+  live.push_back(this);
+}
+
+// quietly drop the connection and anything still scheduled
+Session::~Session()
+{
+  live.erase(std::find(live.begin(), live.end(), this));
+  Capture::forget(this);
+
+  if (connected == true)
+    closeConnection();
+
+  EventLoop::removeTimeout(connectDeadline, this);
+  EventLoop::removeTimeout(attemptTimeout, this);
+  EventLoop::removeTimeout(reconnectNow, this);
+  EventLoop::removeTimeout(resyncTimeout, this);
+  EventLoop::removeTimeout(updateUsersTimeout, this);
+
+  for (size_t i = 0; i < attempts.size(); i++)
+    close_fd(attempts[i]);
+
+  if (ip_info)
+    freeaddrinfo(ip_info);
+
+  if (ssl)
+    SSL_free(ssl);
+
+  closeSocket();
+}
+
+// bring the user pane in line with the table, only touching the rows
+// whose users changed since the last time
+void Session::updateUsers()
+{
+  const Trace::Time traced = Trace::begin();
+  const int changed = changed_users.size();
+
+  for (const int line : changed_users)
+  {
+    UserTable::User *user = users.find(line);
+
+    if (user == 0)
+      continue;
+
+    const auto it = std::lower_bound(shown_users.begin(),
+                                     shown_users.end(), line);
+    const int row = it - shown_users.begin();
+
+    if (user->active == true && user->shown == true)
+    {
+      view->updateUser(this, row, line, user->name);
+    }
+    else if (user->active == true)
+    {
+      view->insertUser(this, row, line, user->name);
+      shown_users.insert(it, line);
+    }
+    else if (user->shown == true)
+    {
+      view->removeUser(this, row);
+      shown_users.erase(it);
+    }
+
+    user->shown = user->active;
+    user->changed = false;
+
+    if (user->active == false)
+      users.erase(line);
+  }
+
+  changed_users.clear();
+  Trace::end("updateUsers", traced, "users", changed);
+}
+
+void Session::updateUsersTimeout(void *data)
+{
+  ((Session *)data)->updateUsers();
+}
+
+// a burst of joins and leaves ends up as one pass per event loop tick
+void Session::showUser(const int line)
+{
+  UserTable::User *user = users.find(line);
+
+  if (user->changed == false)
+  {
+    user->changed = true;
+    changed_users.push_back(line);
+  }
+
+  EventLoop::removeTimeout(updateUsersTimeout, this);
+  EventLoop::addTimeout(0.0, updateUsersTimeout, this);
+}
+
+// drop whoever the server didn't list again after a reconnect
+void Session::resyncDone()
+{
+  resync = false;
+
+  for (auto &entry : users)
+  {
+    if (entry.second.active == true && entry.second.stale == true)
+    {
+      nicks.remove(entry.second.name);
+      users.deactivate(entry.first);
+      showUser(entry.first);
+    }
+
+    entry.second.stale = false;
+  }
+}
+
+void Session::resyncTimeout(void *data)
+{
+  ((Session *)data)->resyncDone();
+}
+
+void Session::addUser(const int line, const char *name)
+{
+  if (line >= 0)
+  {
+    UserTable::User *user = users.add(line);
+
+    if (resync == true)
+    {
+      EventLoop::removeTimeout(resyncTimeout, this);
+      EventLoop::addTimeout(resync_quiet, resyncTimeout, this);
+    }
+
+    user->stale = false;
+
+    // nothing to redraw if we already knew about this one
+    if (user->active == true && strcmp(user->name, name) == 0)
+      return;
+
+    if (user->active == true)
+      nicks.remove(user->name);
+
+    users.setName(line, name);
+    nicks.add(name);
+
+    showUser(line);
+  }
+}
+
+void Session::removeUser(const int line)
+{
+  UserTable::User *user = users.find(line);
+
+  if (user == 0 || user->active == false)
+    return;
+
+  nicks.remove(user->name);
+  users.deactivate(line);
+
+  showUser(line);
+}
+
+// the line is parsed where it lies in the receive buffer, length
+// excludes the newline (whose slot is still there to be reused)
+void Session::handleLine(char *current, const int length)
+{
+  Event events[Parser::MAX_EVENTS];
+  const int count = Parser::scan(current, length, events);
+
+  // only a .Z reply ends with an @ line, joins can arrive at any time
+  if (probe_pending == true && events[0].type == Event::LIST)
+    probeAnswered();
+
+  // put the newline back so each pane takes the line in one append
+  current[length] = '\n';
+
+  for (int i = 0; i < count; i++)
+  {
+    events[i].length = length + 1;
+    event_bus.add(events[i]);
+  }
+}
+
+// pass on every complete line received so far, lines stay in place
+// in the buffer until the whole batch is dispatched
+void Session::handleMsg()
+{
+  const Stats::Time started = Stats::start();
+  const Trace::Time traced = Trace::begin();
+  char *current;
+  int length = 0;
+  int lines = 0;
+
+  while ((current = line_buf.nextLine(&length)) != 0)
+  {
+    if (length > 0)
+    {
+      handleLine(current, length);
+      lines++;
+    }
+  }
+
+  Stats::stop(Stats::PARSE, started, lines);
+  Trace::end("handleMsg", traced, "lines", lines);
+  event_bus.dispatch();
+}
+
+// smoothed rtt the kernel keeps for the connection
+double Session::kernelRtt()
+{
+#ifdef __linux__
+  struct tcp_info info;
+  socklen_t size = sizeof(info);
+
+  if (getsockopt(sock, IPPROTO_TCP, TCP_INFO, &info, &size) == 0)
+    return info.tcpi_rtt / 1000.0;
+#endif
+
+  return 0;
+}
+
+void Session::recordLatency(const double ms)
+{
+  const int bins = Chat::LatencyStats::BINS;
+  const int window = Chat::LatencyStats::WINDOW;
+  int bin = 0;
+
+  while (bin < bins - 1 && ms >= Chat::LatencyStats::bin_limits[bin])
+    bin++;
+
+  if (latency_stats.samples >= window)
+    latency_stats.bins[latency_window[latency_next]]--;
+
+  latency_window[latency_next] = bin;
+  latency_next = (latency_next + 1) % window;
+  latency_stats.bins[bin]++;
+  latency_stats.samples++;
+  latency_stats.last_ms = ms;
+  latency_stats.kernel_ms = kernelRtt();
+
+  view->updateLatency(this);
+}
+
+// the last line of the reply to an outstanding probe, the sample is
+// the kernel's rtt, which the list doesn't stretch, and the time to the
+// end of the list only where the kernel won't say
+void Session::probeAnswered()
+{
+  const std::chrono::duration<double, std::milli> waited =
+    std::chrono::steady_clock::now() - probe_time;
+  const double rtt = kernelRtt();
+
+  probe_pending = false;
+  missed_probes = 0;
+  recordLatency(rtt > 0 ? rtt : waited.count());
+}
+
+// let the kernel notice a dead peer as well, and give up on data the
+// server never acknowledges after as long as the probes would take
+void Session::setKeepaliveOptions()
+{
+  const int on = 1;
+
+  setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, (const char *)&on, sizeof(on));
+
+#ifdef TCP_KEEPIDLE
+  const int idle = probe_interval;
+
+  setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE,
+             (const char *)&idle, sizeof(idle));
+#endif
+
+#ifdef TCP_USER_TIMEOUT
+  const unsigned int timeout = probe_interval * probe_limit * 1000;
+
+  setsockopt(sock, IPPROTO_TCP, TCP_USER_TIMEOUT,
+             (const char *)&timeout, sizeof(timeout));
+#endif
+}
+
+// whoever talks moves to the front of the completion order
+void Session::chatEvents(const Event *events, const int count, void *data)
+{
+  Session *session = (Session *)data;
+
+  for (int i = 0; i < count; i++)
+  {
+    session->nicks.touch(events[i].line + events[i].nick.start,
+                         events[i].nick.length);
+  }
+}
+
+// +[N]name and -[N] keep the user list current
+void Session::userEvents(const Event *events, const int count, void *data)
+{
+  Session *session = (Session *)data;
+
+  for (int i = 0; i < count; i++)
+  {
+    const Event *event = &events[i];
+
+    if (event->type == Event::JOIN)
+    {
+      const std::string name(event->line + event->nick.start,
+                             event->nick.length);
+
+      session->addUser(event->id, name.c_str());
+    }
+      else
+    {
+      session->removeUser(event->id);
+    }
+  }
+}
+
+void Session::countReads(const int reads, const int bytes)
+{
+  read_stats.wakeups++;
+  read_stats.reads += reads;
+  read_stats.bytes += bytes;
+  read_stats.last_reads = reads;
+
+  if (reads > read_stats.max_reads)
+    read_stats.max_reads = reads;
+
+  if (bytes >= read_budget)
+    read_stats.budget_hits++;
+}
+
+// read until the socket would block
+void Session::readPlain()
+{
+  const Stats::Time started = Stats::start();
+  const Trace::Time traced = Trace::begin();
+  int bytes = 0;
+  int reads = 0;
+  bool closed = false;
+
+  while (bytes < read_budget)
+  {
+    char *dest = line_buf.reserve(16384);
+    const int size = recv(sock, dest, 16384, 0);
+
+    if (size > 0)
+    {
+      Capture::record(this, dest, size);
+      line_buf.commit(size);
+      bytes += size;
+      reads++;
+    }
+      else
+    {
+      closed = (size == 0 || would_block() == false);
+      break;
+    }
+  }
+
+  Stats::stop(Stats::RECV, started, bytes);
+  countReads(reads, bytes);
+  handleMsg();
+  Trace::end("readPlain", traced, "bytes", bytes);
+
+  if (closed == true)
+    connectionLost();
+}
+
+void Session::readReady(int, void *data)
+{
+  ((Session *)data)->readPlain();
+}
+
+// read until OpenSSL needs more data and has nothing buffered
+void Session::readSsl()
+{
+  const Stats::Time started = Stats::start();
+  const Trace::Time traced = Trace::begin();
+  int bytes = 0;
+  int reads = 0;
+  bool closed = false;
+
+  while (bytes < read_budget)
+  {
+    char *dest = line_buf.reserve(16384);
+    const int size = SSL_read(ssl, dest, 16384);
+
+    if (size > 0)
+    {
+      Capture::record(this, dest, size);
+      line_buf.commit(size);
+      bytes += size;
+      reads++;
+      continue;
+    }
+
+    const int error = SSL_get_error(ssl, size);
+
+    if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE)
+      closed = true;
+
+    break;
+  }
+
+  Stats::stop(Stats::TLS, started, bytes);
+  countReads(reads, bytes);
+  handleMsg();
+  Trace::end("readSsl", traced, "bytes", bytes);
+
+  if (closed == true)
+  {
+    connectionLost();
+    return;
+  }
+
+  if (flush_after_read == true)
+  {
+    flush_after_read = false;
+    flushOut();
+  }
+
+  // records already decrypted by OpenSSL won't wake up the socket again
+  if (connected == true && SSL_pending(ssl) > 0)
+  {
+    EventLoop::removeTimeout(readSslPending, this);
+    EventLoop::addTimeout(0.0, readSslPending, this);
+  }
+}
+
+void Session::readSslReady(int, void *data)
+{
+  ((Session *)data)->readSsl();
+}
+
+void Session::readSslPending(void *data)
+{
+  ((Session *)data)->readSsl();
+}
+
+void Session::flushReady(int, void *data)
+{
+  ((Session *)data)->flushOut();
+}
+
+void Session::flushTimeout(void *data)
+{
+  ((Session *)data)->flushOut();
+}
+
+// send as much of the queue as the socket takes without blocking
+void Session::flushOut()
+{
+  EventLoop::removeTimeout(flushTimeout, this);
+
+  while (out_sent < out_buf.size())
+  {
+    const int size = out_buf.size() - out_sent;
+    int sent = 0;
+
+    if (enable_ssl == true)
+    {
+      sent = SSL_write(ssl, out_buf.data() + out_sent, size);
+
+      if (sent <= 0)
+      {
+        const int error = SSL_get_error(ssl, sent);
+
+        if (error == SSL_ERROR_WANT_WRITE)
+        {
+          EventLoop::addFd(sock, EventLoop::WRITE, flushReady, this);
+          return;
+        }
+
+        if (error == SSL_ERROR_WANT_READ)
+        {
+          EventLoop::removeFd(sock, EventLoop::WRITE);
+          flush_after_read = true;
+          return;
+        }
+
+        connectionLost();
+        return;
+      }
+    }
+      else
+    {
+      sent = send(sock, out_buf.data() + out_sent, size, 0);
+
+      if (sent < 0)
+      {
+        if (would_block() == true)
+        {
+          EventLoop::addFd(sock, EventLoop::WRITE, flushReady, this);
+          return;
+        }
+
+        connectionLost();
+        return;
+      }
+    }
+
+    out_sent += sent;
+  }
+
+  out_buf.clear();
+  out_sent = 0;
+  EventLoop::removeFd(sock, EventLoop::WRITE);
+}
+
+void Session::closeSocket()
+{
+  if (sock == 0)
+    return;
+
+  close_fd(sock);
+  sock = 0;
+}
+
+void Session::reconnectNow(void *data)
+{
+  Session *session = (Session *)data;
+
+  session->reconnect_pending = false;
+  session->startConnect();
+}
+
+// wait a randomized, growing delay so clients don't all come back at once
+void Session::scheduleReconnect()
+{
+  const double delay = reconnect_delay / 2 +
+    reconnect_delay / 2 * std::uniform_real_distribution<>(0, 1)(jitter);
+
+  char text[256];
+
+  snprintf(text, sizeof(text),
+           ">> JoeClient: Reconnecting in %.1f seconds...\n", delay);
+
+  view->append(this, text);
+
+  reconnect_pending = true;
+  EventLoop::addTimeout(delay, reconnectNow, this);
+
+  reconnect_delay *= 2;
+
+  if (reconnect_delay > reconnect_max)
+    reconnect_delay = reconnect_max;
+}
+
+void Session::stopReconnecting()
+{
+  EventLoop::removeTimeout(reconnectNow, this);
+  EventLoop::removeTimeout(resyncTimeout, this);
+  reconnecting = false;
+  reconnect_pending = false;
+  resync = false;
+
+  view->sessionChanged(this);
+}
+
+// lines passed over by the NetThread, the thread reuses the line's
+// storage so each one is dispatched before the next arrives
+void Session::threadLine(char *line, int length)
+{
+  thread_session->handleLine(line, length);
+
+  // handleLine put the newline back, the capture gets the line whole
+  Capture::record(thread_session, line, length + 1);
+  thread_session->event_bus.dispatch();
+}
+
+void Session::threadClosed()
+{
+  thread_session->connectionLost();
+}
+
+// tear down a connection that was established
+void Session::closeConnection()
+{
+  if (thread_session == this)
+  {
+    NetThread::stop();
+    thread_session = 0;
+  }
+
+  EventLoop::removeTimeout(readSslPending, this);
+  EventLoop::removeTimeout(flushTimeout, this);
+  EventLoop::removeTimeout(keepAlive, this);
+  probe_pending = false;
+  closeSocket();
+
+  out_buf.clear();
+  out_sent = 0;
+
+#ifdef WIN32
+  WSACleanup();
+#endif
+
+  connected = false;
+}
+
+// the server went away without being asked to
+void Session::connectionLost()
+{
+  if (auto_reconnect == false)
+  {
+    disconnect("Disconnected", "Connection Closed");
+    return;
+  }
+
+  closeConnection();
+
+  view->append(this, ">> JoeClient: Connection lost.\n");
+
+  reconnecting = true;
+  reconnect_delay = reconnect_min;
+  down_since = std::chrono::steady_clock::now();
+  scheduleReconnect();
+}
+
+// give up on connecting, message may be 0 when the user cancelled
+void Session::connectFailed(const char *message)
+{
+  EventLoop::removeTimeout(connectDeadline, this);
+  EventLoop::removeTimeout(attemptTimeout, this);
+  resolve_generation = -1;
+
+  for (size_t i = 0; i < attempts.size(); i++)
+    close_fd(attempts[i]);
+
+  attempts.clear();
+  addresses.clear();
+
+  if (ip_info)
+  {
+    freeaddrinfo(ip_info);
+    ip_info = 0;
+  }
+
+  if (ssl)
+  {
+    SSL_free(ssl);
+    ssl = 0;
+  }
+
+  closeSocket();
+
+#ifdef WIN32
+  WSACleanup();
+#endif
+
+  connect_state = STATE_IDLE;
+
+  // keep trying quietly while the connection is down, the view only
+  // hears about connects the user started
+  if (reconnecting == true && message)
+  {
+    scheduleReconnect();
+    return;
+  }
+
+  view->connectFinished(this);
+
+  if (reconnecting == true)
+    stopReconnecting();
+
+  view->sessionChanged(this);
+
+  if (message)
+    view->message(this, "Error", message);
+}
+
+void Session::connectDeadline(void *data)
+{
+  ((Session *)data)->connectFailed("Connection timed out.");
+}
+
+void Session::connectFinished()
+{
+  EventLoop::removeTimeout(connectDeadline, this);
+  connect_state = STATE_IDLE;
+  connected = true;
+
+  if (reconnecting == false)
+    view->connectFinished(this);
+
+  if (reconnecting == true)
+  {
+    const std::chrono::duration<double> down =
+      std::chrono::steady_clock::now() - down_since;
+
+    reconnect_stats.reconnects++;
+    reconnect_stats.last_downtime = down.count();
+    reconnect_stats.total_downtime += down.count();
+
+    char text[256];
+
+    snprintf(text, sizeof(text),
+             ">> JoeClient: Reconnected after %.1f seconds "
+             "(%d reconnects, %.1f seconds down in total)\n",
+             reconnect_stats.last_downtime, reconnect_stats.reconnects,
+             reconnect_stats.total_downtime);
+
+    view->append(this, text);
+
+    reconnecting = false;
+    reconnect_delay = reconnect_min;
+
+    // keep showing the old user list and only apply what changed
+    for (auto &entry : users)
+      entry.second.stale = entry.second.active;
+
+    resync = true;
+    EventLoop::addTimeout(resync_quiet, resyncTimeout, this);
+  }
+
+  view->sessionChanged(this);
+
+  if (keep_alive == true)
+    setKeepaliveOptions();
+
+  const bool started = threaded == true && thread_session == 0 &&
+    NetThread::start(sock, enable_ssl ? ssl : 0,
+                     threadLine, threadClosed) == true;
+
+  if (started == true)
+  {
+    thread_session = this;
+  }
+  else if (enable_ssl == true)
+  {
+    EventLoop::addFd(sock, EventLoop::READ, readSslReady, this);
+  }
+    else
+  {
+    EventLoop::addFd(sock, EventLoop::READ, readReady, this);
+  }
+
+  // announcement
+  char connect_string[256];
+
+  snprintf(connect_string, sizeof(connect_string),
+           "%% has connected using JoeClient");
+
+  write(connect_string);
+
+  // send .Z for user list, its reply is the first probe answered
+  if (keep_alive == true)
+  {
+    probe_pending = true;
+    missed_probes = 0;
+    probe_time = std::chrono::steady_clock::now();
+  }
+
+  write(probe_command);
+
+  if (keep_alive == true)
+    EventLoop::addTimeout(probe_interval, keepAlive, this);
+}
+
+// what resuming the session saved
+void Session::handshakeReport(char *text, const int size, const double ms)
+{
+  const Tls::Timing *timing = Tls::timing();
+
+  snprintf(text, size,
+           ">> JoeClient: TLS handshake %.1f ms (%s), "
+           "average full %.1f ms, resumed %.1f ms\n",
+           ms, SSL_session_reused(ssl) ? "resumed" : "full",
+           timing->full > 0 ? timing->full_ms / timing->full : 0.0,
+           timing->resumed > 0 ? timing->resumed_ms / timing->resumed : 0.0);
+}
+
+void Session::handshakeReady(int, void *data)
+{
+  ((Session *)data)->handshakeStep();
+}
+
+// advance the handshake whenever the socket is ready for what OpenSSL
+// asked for
+void Session::handshakeStep()
+{
+  EventLoop::removeFd(sock);
+
+  const int result = SSL_connect(ssl);
+
+  if (result == 1)
+  {
+    const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - handshake_start;
+
+    char report[256];
+
+    // the network thread may own ssl once connected, ask it first
+    Tls::handshakeDone(ssl, ms.count());
+    handshakeReport(report, sizeof(report), ms.count());
+    connectFinished();
+    view->append(this, report);
+    return;
+  }
+
+  switch (SSL_get_error(ssl, result))
+  {
+    case SSL_ERROR_WANT_READ:
+      EventLoop::addFd(sock, EventLoop::READ, handshakeReady, this);
+      break;
+    case SSL_ERROR_WANT_WRITE:
+      EventLoop::addFd(sock, EventLoop::WRITE, handshakeReady, this);
+      break;
+    default:
+      if (SSL_get_verify_result(ssl) != X509_V_OK)
+      {
+        static char message[256];
+
+        snprintf(message, sizeof(message),
+                 "Certificate verification failed:\n%s",
+                 X509_verify_cert_error_string(
+                   SSL_get_verify_result(ssl)));
+
+        connectFailed(message);
+      }
+        else
+      {
+        connectFailed("Server does not support SSL.");
+      }
+
+      break;
+  }
+}
+
+void Session::tcpConnected()
+{
+  if (enable_ssl == false)
+  {
+    connectFinished();
+    return;
+  }
+
+  SSL_free(ssl);
+  ssl = Tls::create(server_host.c_str(), server_port);
+
+  if (ssl == 0)
+  {
+    connectFailed(Tls::error());
+    return;
+  }
+
+  SSL_set_fd(ssl, sock);
+
+  // the queue may grow or move between retries of a partial write
+  SSL_set_mode(ssl, SSL_MODE_ENABLE_PARTIAL_WRITE |
+                    SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+  connect_state = STATE_HANDSHAKING;
+  handshake_start = std::chrono::steady_clock::now();
+  handshakeStep();
+}
+
+// first address to connect wins, the rest are dropped
+void Session::attemptWon(const int fd)
+{
+  EventLoop::removeTimeout(attemptTimeout, this);
+  EventLoop::removeFd(fd);
+
+  for (size_t i = 0; i < attempts.size(); i++)
+  {
+    if (attempts[i] != fd)
+      close_fd(attempts[i]);
+  }
+
+  attempts.clear();
+  addresses.clear();
+  freeaddrinfo(ip_info);
+  ip_info = 0;
+
+  sock = fd;
+  tcpConnected();
+}
+
+// a non-blocking connect() has completed, one way or the other
+void Session::attemptReady(int fd, void *data)
+{
+  Session *session = (Session *)data;
+  int error = 0;
+  socklen_t length = sizeof(error);
+
+  getsockopt(fd, SOL_SOCKET, SO_ERROR, (char *)&error, &length);
+
+  if (error == 0)
+  {
+    session->attemptWon(fd);
+    return;
+  }
+
+  std::vector<int> *attempts = &session->attempts;
+
+  for (size_t i = 0; i < attempts->size(); i++)
+  {
+    if ((*attempts)[i] == fd)
+    {
+      attempts->erase(attempts->begin() + i);
+      break;
+    }
+  }
+
+  close_fd(fd);
+
+  // don't wait out the delay when an attempt has already failed
+  EventLoop::removeTimeout(attemptTimeout, session);
+  session->startAttempt();
+}
+
+void Session::attemptTimeout(void *data)
+{
+  ((Session *)data)->startAttempt();
+}
+
+// start connecting to the next address while earlier ones keep trying
+void Session::startAttempt()
+{
+  while (next_address < addresses.size())
+  {
+    struct addrinfo *p = addresses[next_address++];
+    const int fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+
+    if (fd == -1)
+      continue;
+
+    if (set_non_blocking(fd) == false)
+    {
+      close_fd(fd);
+      continue;
+    }
+
+    if (::connect(fd, p->ai_addr, p->ai_addrlen) == 0)
+    {
+      attemptWon(fd);
+      return;
+    }
+
+    if (in_progress() == false)
+    {
+      close_fd(fd);
+      continue;
+    }
+
+    // failures show up as an exception on Windows
+    attempts.push_back(fd);
+    EventLoop::addFd(fd, EventLoop::WRITE | EventLoop::EXCEPT, attemptReady, this);
+
+    if (next_address < addresses.size())
+      EventLoop::addTimeout(attempt_delay, attemptTimeout, this);
+
+    return;
+  }
+
+  if (attempts.empty())
+    connectFailed("Could not connect.");
+}
+
+// back on the event loop with the lookup, which may be stale by now
+void Session::resolveDone(void *data)
+{
+  resolve_result *result = (resolve_result *)data;
+  Session *session = result->session;
+  const bool current =
+    std::find(live.begin(), live.end(), session) != live.end() &&
+    result->generation == session->resolve_generation &&
+    session->connect_state == STATE_RESOLVING;
+
+  if (current == false)
+  {
+    if (result->list)
+      freeaddrinfo(result->list);
+
+    delete result;
+    return;
+  }
+
+  const int error = result->error;
+  struct addrinfo *list = result->list;
+
+  delete result;
+  session->resolved(error, list);
+}
+
+void Session::resolved(const int error, struct addrinfo *list)
+{
+  ip_info = list;
+
+  if (error != 0 || ip_info == 0)
+  {
+    connectFailed("Could not obtain IP address.");
+    return;
+  }
+
+  // alternate address families, starting with the preferred one
+  std::vector<struct addrinfo *> preferred;
+  std::vector<struct addrinfo *> other;
+
+  for (struct addrinfo *p = ip_info; p != 0; p = p->ai_next)
+  {
+    if (p->ai_family == ip_info->ai_family)
+      preferred.push_back(p);
+    else
+      other.push_back(p);
+  }
+
+  addresses.clear();
+  next_address = 0;
+
+  for (size_t i = 0; i < preferred.size() || i < other.size(); i++)
+  {
+    if (i < preferred.size())
+      addresses.push_back(preferred[i]);
+
+    if (i < other.size())
+      addresses.push_back(other[i]);
+  }
+
+  connect_state = STATE_CONNECTING;
+  startAttempt();
+}
+
+// state that belongs to one connection, kept over reconnects
+void Session::startConnect()
+{
+  line_buf.clear();
+  out_buf.clear();
+  out_sent = 0;
+  flush_after_read = false;
+  read_stats = Chat::ReadStats();
+
+#ifdef WIN32
+  if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0)
+  {
+    view->connectFinished(this);
+    view->message(this, "Error", "Could not initialize Winsock.");
+    return;
+  }
+#endif
+
+  connect_state = STATE_RESOLVING;
+  resolve_generation = next_generation++;
+  EventLoop::addTimeout(connect_timeout, connectDeadline, this);
+
+  resolve_result *result = new resolve_result;
+
+  result->done = resolveDone;
+  result->session = this;
+  result->generation = resolve_generation;
+
+  std::thread(resolve, server_host, std::to_string(server_port),
+              result).detach();
+
+  view->sessionChanged(this);
+}
+
+void Session::connect(const char *address, const int port,
+                      const bool enable_ssl_value,
+                      const bool keep_alive_value,
+                      const bool auto_reconnect_value)
+{
+  if (connected == true || connect_state != STATE_IDLE ||
+      reconnecting == true)
+  {
+    return;
+  }
+
+  users.clear();
+  nicks.clear();
+  changed_users.clear();
+  shown_users.clear();
+
+  EventLoop::removeTimeout(updateUsersTimeout, this);
+  view->clearUsers(this);
+
+  enable_ssl = enable_ssl_value;
+  keep_alive = keep_alive_value;
+  auto_reconnect = auto_reconnect_value;
+  server_host = address;
+  server_port = port;
+
+  startConnect();
+}
+
+void Session::cancelConnect()
+{
+  if (reconnecting == true)
+    stopReconnecting();
+
+  if (connect_state != STATE_IDLE)
+    connectFailed(0);
+}
+
+void Session::userDisconnected()
+{
+  if (connect_state != STATE_IDLE || reconnecting == true)
+  {
+    cancelConnect();
+    return;
+  }
+
+  disconnect("Disconnected", "Connection Closed");
+}
+
+void Session::disconnect(const char *title, const char *message)
+{
+  if (connected == true)
+  {
+    closeConnection();
+    stopReconnecting();
+    view->message(this, title, message);
+  }
+
+  if (read_stats.wakeups == 0)
+  {
+    view->append(this, ">> JoeClient: Connection closed.\n");
+    return;
+  }
+
+  char text[256];
+
+  snprintf(text, sizeof(text),
+           ">> JoeClient: Connection closed. "
+           "(%lu reads in %lu wakeups, up to %d per wakeup)\n",
+           read_stats.reads, read_stats.wakeups, read_stats.max_reads);
+
+  view->append(this, text);
+}
+
+// queue a line, everything queued during one callback goes out together
+void Session::write(const char *message)
+{
+  // remember our own nick for highlighting
+  if (strncmp(message, ".n ", 3) == 0)
+    highlighter.setNick(message + 3);
+
+  if (thread_session == this && NetThread::running() == true)
+  {
+    NetThread::write(message);
+    return;
+  }
+
+  if (connected == true)
+  {
+    const bool idle = out_buf.empty();
+
+    out_buf.insert(out_buf.end(), message, message + strlen(message));
+    out_buf.push_back('\n');
+
+    if (idle == true)
+      EventLoop::addTimeout(0.0, flushTimeout, this);
+  }
+}
+
+// a tab for traffic from a capture, named after the file and stream
+void Session::startReplay(const char *name, const int stream)
+{
+  users.clear();
+  nicks.clear();
+  changed_users.clear();
+  shown_users.clear();
+  line_buf.clear();
+
+  EventLoop::removeTimeout(updateUsersTimeout, this);
+  view->clearUsers(this);
+
+  server_host = name;
+  server_port = stream;
+
+  view->sessionChanged(this);
+}
+
+// bytes from a capture, handled as if they had just been read
+void Session::feed(const char *data, const int size)
+{
+  line_buf.append(data, size);
+  countReads(1, size);
+  handleMsg();
+}
+
+// probe the server once per interval, a link that leaves probe_limit
+// probes in a row unanswered is treated as dead
+void Session::keepAlive(void *data)
+{
+  Session *session = (Session *)data;
+  const Trace::Time traced = Trace::begin();
+
+  if (session->connected && session->keep_alive)
+  {
+    if (session->probe_pending == true)
+    {
+      session->missed_probes++;
+      session->latency_stats.missed++;
+      view->updateLatency(session);
+
+      if (session->missed_probes >= session->probe_limit)
+      {
+        session->connectionLost();
+        Trace::end("keepAlive", traced);
+        return;
+      }
+    }
+      else
+    {
+      session->probe_pending = true;
+      session->probe_time = std::chrono::steady_clock::now();
+      session->write(probe_command);
+    }
+  }
+
+  Trace::end("keepAlive", traced);
+  EventLoop::repeatTimeout(session->probe_interval, keepAlive, data);
+}
+
+// nicks starting with prefix, most recently active first
+int Session::completeNick(const char *prefix, const int length,
+                          std::vector<std::string> *result)
+{
+  return nicks.complete(prefix, length, result);
+}
+
+// takes effect on the next connect
+void Session::setThreaded(const bool value)
+{
+  threaded = value;
+}
+
+// unanswered probes before the link counts as dead
+void Session::setProbeLimit(const int limit)
+{
+  probe_limit = limit;
+
+  if (connected == true && keep_alive == true)
+    setKeepaliveOptions();
+}
+
+// seconds between probes, the next one is a whole interval away
+void Session::setProbeInterval(const int seconds)
+{
+  probe_interval = seconds;
+
+  if (connected == true && keep_alive == true)
+  {
+    setKeepaliveOptions();
+    EventLoop::removeTimeout(keepAlive, this);
+    EventLoop::addTimeout(probe_interval, keepAlive, this);
+  }
+}
+
+bool Session::isConnected()
+{
+  return connected;
+}
+
+bool Session::isConnecting()
+{
+  return connect_state != STATE_IDLE || reconnecting == true;
+}
+
+// empty until the first connect
+const char *Session::host()
+{
+  return server_host.c_str();
+}
+
+int Session::port()
+{
+  return server_port;
+}
+
+// users in the pane
+int Session::userCount()
+{
+  return shown_users.size();
+}
+
+// received bytes still waiting for the end of their line
+int Session::unparsedBytes()
+{
+  return line_buf.pending();
+}
+
+Events *Session::events()
+{
+  return &event_bus;
+}
+
+Highlight *Session::highlight()
+{
+  return &highlighter;
+}
+
+SendQueue *Session::sendQueue()
+{
+  return &send_queue;
+}
+
+// lines the send queue has let out of those queued
+void Session::sendProgress(const int sent, const int total)
+{
+  view->sendProgress(this, sent, total);
+}
+
+const Chat::ReadStats *Session::readStats()
+{
+  return &read_stats;
+}
+
+const Chat::ReconnectStats *Session::reconnectStats()
+{
+  return &reconnect_stats;
+}
+
+const Chat::LatencyStats *Session::latencyStats()
+{
+  return &latency_stats;
+}
+
+// heap memory held by the session's buffers and tables, the panes
+// are counted by whoever owns them
+size_t Session::memoryUsed()
+{
+  return sizeof(Session) + line_buf.capacity() + out_buf.capacity() +
+         users.memoryUsed() + nicks.memoryUsed() +
+         (changed_users.capacity() + shown_users.capacity()) * sizeof(int);
+}
+
+// set once at startup by the gui or the headless runner
+void Session::setView(SessionView *value)
+{
+  view = value;
+}
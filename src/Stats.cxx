@@ -0,0 +1,131 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "Stats.H"
+
+namespace
+{
+  bool on = false;
+
+  struct stage
+  {
+    unsigned long calls;
+    unsigned long items;
+    double total_ms;
+
+    // the last WINDOW timings, oldest overwritten first
+    std::array<float, Stats::WINDOW> recent;
+    int next;
+    int count;
+  };
+
+  std::array<stage, Stats::STAGE_COUNT> stages;
+
+  const char *names[Stats::STAGE_COUNT] =
+  {
+    "recv",
+    "tls",
+    "parse",
+    "append",
+    "trim",
+    "redraw"
+  };
+}
+
+// counts start over from zero when turned on
+void Stats::setEnabled(const bool value)
+{
+  if (value == true && on == false)
+  {
+    for (stage &s : stages)
+    {
+      s.calls = 0;
+      s.items = 0;
+      s.total_ms = 0;
+      s.next = 0;
+      s.count = 0;
+    }
+  }
+
+  on = value;
+}
+
+bool Stats::enabled()
+{
+  return on;
+}
+
+// the clock is only read when enabled, a default time means off
+Stats::Time Stats::start()
+{
+  if (on == false)
+    return Time();
+
+  return std::chrono::steady_clock::now();
+}
+
+void Stats::stop(const int index, const Time started,
+                 const unsigned long items)
+{
+  if (started == Time())
+    return;
+
+  const std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - started;
+  stage *s = &stages[index];
+
+  s->calls++;
+  s->items += items;
+  s->total_ms += elapsed.count();
+  s->recent[s->next] = elapsed.count();
+  s->next = (s->next + 1) % WINDOW;
+
+  if (s->count < WINDOW)
+    s->count++;
+}
+
+// totals so far and percentiles of the recent timings
+void Stats::get(const int index, Stage *result)
+{
+  const stage *s = &stages[index];
+  std::vector<float> sorted(s->recent.begin(), s->recent.begin() + s->count);
+
+  result->calls = s->calls;
+  result->items = s->items;
+  result->total_ms = s->total_ms;
+  result->p50_ms = 0;
+  result->p99_ms = 0;
+
+  if (sorted.empty() == true)
+    return;
+
+  std::sort(sorted.begin(), sorted.end());
+  result->p50_ms = sorted[sorted.size() / 2];
+  result->p99_ms = sorted[sorted.size() * 99 / 100];
+}
+
+const char *Stats::name(const int index)
+{
+  return names[index];
+}
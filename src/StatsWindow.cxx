@@ -0,0 +1,163 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <cstdio>
+
+#include <FL/Fl.H>
+#include <FL/fl_draw.H>
+
+#include "Chat.H"
+#include "Gui.H"
+#include "Language.H"
+#include "Session.H"
+#include "StatsWindow.H"
+
+StatsWindow::StatsWindow()
+: Fl_Double_Window(520, 290, Language::get(Language::STATS)),
+  seconds(0)
+{
+  end();
+}
+
+StatsWindow::~StatsWindow()
+{
+}
+
+// counts start from zero each time the window opens
+void StatsWindow::show()
+{
+  Stats::setEnabled(true);
+
+  for (int i = 0; i < Stats::STAGE_COUNT; i++)
+  {
+    last[i] = Stats::Stage();
+    rates[i] = Stats::Stage();
+  }
+
+  last_time = std::chrono::steady_clock::now();
+  seconds = 0;
+
+  Fl::add_timeout(1.0, tick, this);
+  Fl_Double_Window::show();
+}
+
+void StatsWindow::hide()
+{
+  Fl::remove_timeout(tick, this);
+  Stats::setEnabled(false);
+  Fl_Double_Window::hide();
+}
+
+void StatsWindow::tick(void *data)
+{
+  ((StatsWindow *)data)->update();
+  Fl::repeat_timeout(1.0, tick, data);
+}
+
+// differences since the last tick, percentiles as they are
+void StatsWindow::update()
+{
+  const std::chrono::steady_clock::time_point now =
+    std::chrono::steady_clock::now();
+  const std::chrono::duration<double> elapsed = now - last_time;
+
+  seconds = elapsed.count();
+  last_time = now;
+
+  for (int i = 0; i < Stats::STAGE_COUNT; i++)
+  {
+    Stats::Stage stage;
+
+    Stats::get(i, &stage);
+
+    rates[i].calls = stage.calls - last[i].calls;
+    rates[i].items = stage.items - last[i].items;
+    rates[i].total_ms = stage.total_ms - last[i].total_ms;
+    rates[i].p50_ms = stage.p50_ms;
+    rates[i].p99_ms = stage.p99_ms;
+    last[i] = stage;
+  }
+
+  redraw();
+}
+
+void StatsWindow::draw()
+{
+  const double per_second = seconds > 0 ? 1 / seconds : 0;
+  const Stats::Stage *recv = &rates[Stats::RECV];
+  const Stats::Stage *tls = &rates[Stats::TLS];
+  const Stats::Stage *frames = &rates[Stats::REDRAW];
+  const Chat::ReadStats *reads = Chat::readStats();
+  const Chat::ReconnectStats *reconnects = Chat::reconnectStats();
+  const int line_h = 18;
+  char text[256];
+  int y = 8;
+
+  fl_rectf(0, 0, w(), h(), FL_BACKGROUND2_COLOR);
+  fl_font(FL_COURIER, 14);
+  fl_color(FL_FOREGROUND_COLOR);
+
+  auto line = [&](const char *s)
+  {
+    fl_draw(s, 8, y, w() - 16, line_h, FL_ALIGN_LEFT | FL_ALIGN_INSIDE);
+    y += line_h;
+  };
+
+  snprintf(text, sizeof(text), "received  %9.1f KB/s %9.0f lines/s",
+           (recv->items + tls->items) * per_second / 1000,
+           rates[Stats::PARSE].items * per_second);
+  line(text);
+
+  snprintf(text, sizeof(text), "users     %9d      scrollback %9.1f KB",
+           Chat::current()->userCount(), Gui::scrollbackBytes() / 1000.0);
+  line(text);
+
+  snprintf(text, sizeof(text), "frames    %9.0f /s   p50 %6.2f ms p99 %6.2f ms",
+           frames->calls * per_second, frames->p50_ms, frames->p99_ms);
+  line(text);
+
+  snprintf(text, sizeof(text), "reads     %9.1f /wakeup max %6d   budget hits %lu",
+           reads->wakeups > 0 ? (double)reads->reads / reads->wakeups : 0.0,
+           reads->max_reads, reads->budget_hits);
+  line(text);
+
+  snprintf(text, sizeof(text), "reconnect %9d      down %7.1f s  last %6.1f s",
+           reconnects->reconnects, reconnects->total_downtime,
+           reconnects->last_downtime);
+  line(text);
+
+  snprintf(text, sizeof(text), "waiting   %9d B partial line %6d lines to send",
+           Chat::current()->unparsedBytes(),
+           Chat::current()->sendQueue()->pending());
+  line(text);
+
+  y += line_h / 2;
+  line("stage        calls/s    ms/s    p50 ms    p99 ms");
+
+  for (int i = 0; i < Stats::STAGE_COUNT; i++)
+  {
+    const Stats::Stage *stage = &rates[i];
+
+    snprintf(text, sizeof(text), "%-8s %11.0f %7.1f %9.3f %9.3f",
+             Stats::name(i), stage->calls * per_second,
+             stage->total_ms * per_second, stage->p50_ms, stage->p99_ms);
+    line(text);
+  }
+}
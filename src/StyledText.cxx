@@ -25,6 +25,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
 #include <FL/Fl_Text_Buffer.H>
 #include <FL/Fl_Text_Display.H>
 
+#include "Scan.H"
+#include "Stats.H"
 #include "StyledText.H"
 
 namespace
@@ -37,10 +39,68 @@ namespace
     { 0x77777700, FL_HELVETICA_BOLD_ITALIC, 16 },
     { 0x77777700, FL_HELVETICA_ITALIC, 16 },
     { 0x77777700, FL_HELVETICA_BOLD, 16 },
-    { 0x00000000, FL_HELVETICA, 16 }
+    { 0x00000000, FL_HELVETICA, 16 },
+    { 0xd0602000, FL_HELVETICA_BOLD, 16 }
   };
 
   const int style_table_size = sizeof(style_table) / sizeof(style_table[0]);
+
+  // style count bytes from index, switching styles at split
+  void fill_style(char *buf, int index, int count, const int split,
+                  const char style1, const char style2)
+  {
+    if (index < split)
+    {
+      const int len = count < split - index ? count : split - index;
+
+      memset(buf + index, style1, len);
+      index += len;
+      count -= len;
+    }
+
+    memset(buf + index, style2, count);
+  }
+
+  // one style byte per text byte
+  void make_styles(char *buf, const char *text, const int utf_len,
+                   const int split, const char style1, const char style2)
+  {
+    int index = 0;
+
+    while (index < utf_len)
+    {
+      // whole runs of ascii are styled at once
+      const int run = Scan::asciiRun(text + index, utf_len - index);
+
+      if (run > 0)
+      {
+        fill_style(buf, index, run, split, style1, style2);
+        index += run;
+        continue;
+      }
+
+      int len = fl_utf8len1(text[index]);
+
+      // don't run past a character cut off at the end
+      if (len > utf_len - index)
+        len = utf_len - index;
+
+      // keep a multi-byte character in one style
+      memset(buf + index, index < split ? style1 : style2, len);
+      index += len;
+    }
+
+    for (index = 0; index < utf_len; index++)
+    {
+      const int found = Scan::findByte(text + index, utf_len - index, '\n', '\r');
+
+      if (found < 0)
+        break;
+
+      index += found;
+      buf[index] = '\n';
+    }
+  }
 }
 
 StyledText::StyledText(int x, int y, int w, int h, int limit)
@@ -73,84 +133,54 @@ StyledText::~StyledText()
 // plain text version
 void StyledText::append(const char *text)
 {
-  append(text, "", "", 'A', 'A');
+  append(text, strlen(text), 0, 'A', 'A');
+}
+
+void StyledText::append(const char *text, const int length)
+{
+  append(text, length, 0, 'A', 'A');
 }
 
-// styled version
+// styled version, text doesn't need to be null-terminated
+// style1 is used before the split offset and style2 from it on
 void StyledText::append(const char *text,
-                        const char *match1,
-                        const char *match2,
+                        const int utf_len,
+                        const int split,
                         const char style1,
                         const char style2)
 {
-  const int utf_len = strlen(text);
-  char buf[utf_len + 1];
-  int index = 0;
-  char current_style = style1;
-
-  const char *p1 = std::strstr(text, match1);
-  const char *p2 = std::strstr(text, match2);
-  int index1 = -1;
-  int index2 = -1;
-
-  if (p1)
-  {
-    index1 = p1 - text;
-    index1 += strlen(match1);
-  }
-  
-  if (p2)
-  {
-    index2 = p2 - text;
-    index2 += strlen(match2);
-  }
-
-  while (true)
-  {
-    int len = fl_utf8len1(text[index]);
+  append(text, utf_len, split, style1, style2, 0, 0);
+}
 
-    if (text[index] == '\n' || text[index] == '\r')
-    {
-      buf[index] = '\n';
-      index++;
-      break;
-    }
-      else
-    {
-      if (index == index1)
-      {
-        current_style = style1;
-      }
-      else if (index == index2)
-      {
-        current_style = style2;
-      }
+// same, with highlighted spans drawn in their own style
+void StyledText::append(const char *text,
+                        const int utf_len,
+                        const int split,
+                        const char style1,
+                        const char style2,
+                        const Event::Span *marks,
+                        const int mark_count)
+{
+  if (utf_len <= 0)
+    return;
 
-      buf[index] = current_style;
+  const Stats::Time started = Stats::start();
+  char buf[utf_len + 1];
 
-      if (len > 1)
-      {
-        for (int i = 1; i < len; i++)
-        {
-          buf[index + i] = current_style;
-        }
-      }
-    }
+  make_styles(buf, text, utf_len, split, style1, style2);
 
-    index += len;
+  for (int i = 0; i < mark_count; i++)
+    memset(buf + marks[i].start, 'H', marks[i].length);
 
-    if (index >= utf_len)
-    {
-      index = utf_len;
-      break;
-    }
-  }
+  buf[utf_len] = '\0';
+  text_buf->append(text, utf_len);
+  style_buf->append(buf, utf_len);
 
-  buf[index] = '\0';
-  text_buf->append(text);
-  style_buf->append(buf);
+  Stats::stop(Stats::APPEND, started, utf_len);
 
+  const Stats::Time trim_started = Stats::start();
   int lines = text_buf->count_lines(0, text_buf->length() - 1);
+  int removed = 0;
 
   while (lines > scrollback_limit)
   {
@@ -159,19 +189,69 @@ void StyledText::append(const char *text,
     text_buf->remove(0, num);
     style_buf->remove(0, num);
     lines--;
+    removed++;
   }
 
+  Stats::stop(Stats::TRIM, trim_started, removed);
+
   // scroll display to bottom
   text_display->insert_position(text_buf->length());
   text_display->show_insert_position();
 }
 
+// lines count from 0, text includes the newline
+void StyledText::insertLine(const int line,
+                            const char *text,
+                            const int utf_len,
+                            const int split,
+                            const char style1,
+                            const char style2)
+{
+  char buf[utf_len + 1];
+  const int pos = text_buf->skip_lines(0, line);
+
+  make_styles(buf, text, utf_len, split, style1, style2);
+  text_buf->insert(pos, text, utf_len);
+  style_buf->insert(pos, buf, utf_len);
+}
+
+void StyledText::replaceLine(const int line,
+                             const char *text,
+                             const int utf_len,
+                             const int split,
+                             const char style1,
+                             const char style2)
+{
+  char buf[utf_len + 1];
+  const int pos = text_buf->skip_lines(0, line);
+  const int end = text_buf->skip_lines(pos, 1);
+
+  make_styles(buf, text, utf_len, split, style1, style2);
+  text_buf->replace(pos, end, text, utf_len);
+  style_buf->replace(pos, end, buf, utf_len);
+}
+
+void StyledText::removeLine(const int line)
+{
+  const int pos = text_buf->skip_lines(0, line);
+  const int end = text_buf->skip_lines(pos, 1);
+
+  text_buf->remove(pos, end);
+  style_buf->remove(pos, end);
+}
+
 void StyledText::clear()
 {
   text_buf->text("");
   style_buf->text("");
 }
 
+// text and style bytes held for the scrollback
+int StyledText::bytes()
+{
+  return text_buf->length() + style_buf->length();
+}
+
 void StyledText::setFontSize(const int size)
 {
   for (int i = 0; i < style_table_size; i++)
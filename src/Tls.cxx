@@ -0,0 +1,360 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#ifdef WIN32
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <arpa/inet.h>
+#endif
+
+#include "EventLoop.H"
+#include "Tls.H"
+
+namespace
+{
+  // one context for the life of the program, so the trust store is only
+  // loaded once and sessions can be resumed
+  SSL_CTX *ctx = 0;
+  const char *ctx_error = 0;
+
+  // newest session ticket for each host:port
+  struct cache_entry
+  {
+    SSL_SESSION *session = 0;
+  };
+
+  std::map<std::string, cache_entry> cache;
+
+  // tickets may arrive on a NetThread
+  std::mutex cache_lock;
+
+  // a ticket came in since the file was last written, a burst of them
+  // is written out once, this long after the first
+  bool dirty = false;
+  const double save_delay = 5;
+
+  Tls::Timing handshake_timing;
+
+  std::string cache_path()
+  {
+#ifdef WIN32
+    const char *dir = getenv("APPDATA");
+#else
+    const char *dir = getenv("HOME");
+#endif
+
+    if (dir == 0)
+      return "";
+
+#ifdef WIN32
+    return std::string(dir) + "\\joeclient_sessions";
+#else
+    return std::string(dir) + "/.joeclient_sessions";
+#endif
+  }
+
+  bool expired(SSL_SESSION *session)
+  {
+    return SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session)
+             < (long)time(0);
+  }
+
+  // file is a list of "host:port" lines, each followed by a PEM session
+  void load_cache()
+  {
+    const std::string path = cache_path();
+
+    if (path.empty())
+      return;
+
+    FILE *fp = fopen(path.c_str(), "r");
+
+    if (fp == 0)
+      return;
+
+    char key[1024];
+
+    while (fgets(key, sizeof(key), fp) != 0)
+    {
+      key[strcspn(key, "\r\n")] = '\0';
+
+      SSL_SESSION *session = PEM_read_SSL_SESSION(fp, 0, 0, 0);
+
+      if (session == 0)
+        break;
+
+      if (expired(session) == true)
+      {
+        SSL_SESSION_free(session);
+        continue;
+      }
+
+      cache_entry &entry = cache[key];
+
+      if (entry.session)
+        SSL_SESSION_free(entry.session);
+
+      entry.session = session;
+    }
+
+    fclose(fp);
+  }
+
+  // the file is written outside the lock, from references taken under
+  // it
+  void save_cache()
+  {
+    std::vector<std::pair<std::string, SSL_SESSION *> > sessions;
+
+    {
+      std::lock_guard<std::mutex> lock(cache_lock);
+
+      if (dirty == false)
+        return;
+
+      dirty = false;
+
+      for (auto i = cache.begin(); i != cache.end(); ++i)
+      {
+        SSL_SESSION *session = i->second.session;
+
+        if (session == 0 || expired(session) == true)
+          continue;
+
+        SSL_SESSION_up_ref(session);
+        sessions.push_back(std::make_pair(i->first, session));
+      }
+    }
+
+    const std::string path = cache_path();
+    FILE *fp = 0;
+
+    // sessions hold key material, keep them private
+    if (path.empty() == false)
+    {
+#ifdef WIN32
+      fp = fopen(path.c_str(), "w");
+#else
+      const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+
+      fp = fd == -1 ? 0 : fdopen(fd, "w");
+#endif
+    }
+
+    for (const auto &entry : sessions)
+    {
+      if (fp != 0)
+      {
+        fprintf(fp, "%s\n", entry.first.c_str());
+        PEM_write_SSL_SESSION(fp, entry.second);
+      }
+
+      SSL_SESSION_free(entry.second);
+    }
+
+    if (fp != 0)
+      fclose(fp);
+  }
+
+  void save_timeout(void *)
+  {
+    save_cache();
+  }
+
+  // runs on the event loop's thread whichever thread got the ticket
+  void schedule_save(void *)
+  {
+    EventLoop::removeTimeout(save_timeout, 0);
+    EventLoop::addTimeout(save_delay, save_timeout, 0);
+  }
+
+  // tickets can arrive any time after the handshake (TLS 1.3)
+  int new_session(SSL *ssl, SSL_SESSION *session)
+  {
+    cache_entry *entry = (cache_entry *)SSL_get_app_data(ssl);
+
+    if (entry == 0)
+      return 0;
+
+    std::lock_guard<std::mutex> lock(cache_lock);
+
+    if (entry->session)
+      SSL_SESSION_free(entry->session);
+
+    entry->session = session;
+
+    if (dirty == false)
+    {
+      dirty = true;
+      EventLoop::awake(schedule_save, 0);
+    }
+
+    // keep the reference
+    return 1;
+  }
+
+  bool init()
+  {
+    ctx = SSL_CTX_new(TLS_client_method());
+
+    if (ctx == 0)
+    {
+      ctx_error = "SSL_CTX_new failed";
+      return false;
+    }
+
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, 0);
+
+#ifdef WIN32
+    if (SSL_CTX_load_verify_locations(ctx, "cacert.pem", 0) == 0)
+    {
+      ctx_error = "Could not load certificate file (cacert.pem).";
+      SSL_CTX_free(ctx);
+      ctx = 0;
+      return false;
+    }
+#else
+    SSL_CTX_set_default_verify_paths(ctx);
+
+    // extra trust for private servers comes from the user's own file,
+    // never from whatever directory the client was started in
+    const char *home = getenv("HOME");
+
+    if (home != 0)
+    {
+      const std::string path = std::string(home) + "/.joeclient_cacert.pem";
+
+      if (SSL_CTX_load_verify_locations(ctx, path.c_str(), 0) == 0)
+        ERR_clear_error();
+    }
+#endif
+
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT |
+                                        SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, new_session);
+
+    load_cache();
+
+    return true;
+  }
+}
+
+// new connection object for host:port, resuming an earlier session if
+// there is one
+SSL *Tls::create(const char *host, const int port)
+{
+  if (ctx == 0 && init() == false)
+    return 0;
+
+  SSL *ssl = SSL_new(ctx);
+
+  if (ssl == 0)
+  {
+    ctx_error = "SSL_new failed";
+    return 0;
+  }
+
+  // check the certificate against the name we connected to
+  unsigned char addr[16];
+
+  if (inet_pton(AF_INET, host, addr) == 1 ||
+      inet_pton(AF_INET6, host, addr) == 1)
+  {
+    X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), host);
+  }
+    else
+  {
+    SSL_set_tlsext_host_name(ssl, host);
+    SSL_set1_host(ssl, host);
+  }
+
+  char key[1024];
+
+  snprintf(key, sizeof(key), "%s:%d", host, port);
+
+  std::lock_guard<std::mutex> lock(cache_lock);
+
+  cache_entry &entry = cache[key];
+
+  SSL_set_app_data(ssl, &entry);
+
+  if (entry.session)
+  {
+    if (expired(entry.session) == true)
+    {
+      SSL_SESSION_free(entry.session);
+      entry.session = 0;
+    }
+      else
+    {
+      SSL_set_session(ssl, entry.session);
+    }
+  }
+
+  return ssl;
+}
+
+const char *Tls::error()
+{
+  return ctx_error;
+}
+
+void Tls::handshakeDone(SSL *ssl, const double ms)
+{
+  if (SSL_session_reused(ssl))
+  {
+    handshake_timing.resumed++;
+    handshake_timing.resumed_ms += ms;
+  }
+    else
+  {
+    handshake_timing.full++;
+    handshake_timing.full_ms += ms;
+  }
+}
+
+const Tls::Timing *Tls::timing()
+{
+  return &handshake_timing;
+}
+
+// write out tickets still waiting for the timeout, before exiting
+void Tls::saveCache()
+{
+  EventLoop::removeTimeout(save_timeout, 0);
+  save_cache();
+}
@@ -0,0 +1,107 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <chrono>
+#include <cstdio>
+
+#include "Trace.H"
+
+namespace
+{
+  FILE *file = 0;
+  Trace::Time origin;
+
+  double micros(const Trace::Time time)
+  {
+    const std::chrono::duration<double, std::micro> elapsed = time - origin;
+
+    return elapsed.count();
+  }
+}
+
+// false if the file can't be written, a trace already going is
+// finished first
+bool Trace::start(const char *path)
+{
+  stop();
+
+  file = fopen(path, "w");
+
+  if (file == 0)
+    return false;
+
+  setvbuf(file, 0, _IOFBF, 1 << 20);
+  origin = std::chrono::steady_clock::now();
+
+  fprintf(file, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"tid\":1,\"args\":{\"name\":\"JoeClient\"}}");
+
+  return true;
+}
+
+void Trace::stop()
+{
+  if (file == 0)
+    return;
+
+  fprintf(file, "\n]\n");
+  fclose(file);
+  file = 0;
+}
+
+bool Trace::active()
+{
+  return file != 0;
+}
+
+// the clock is only read while tracing, a default time means off
+Trace::Time Trace::begin()
+{
+  if (file == 0)
+    return Time();
+
+  return std::chrono::steady_clock::now();
+}
+
+// one complete event, with a number attached if arg is given
+void Trace::end(const char *name, const Time started,
+                const char *arg, const long value)
+{
+  if (started == Time() || file == 0)
+    return;
+
+  const Time now = std::chrono::steady_clock::now();
+
+  fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                "\"ts\":%.3f,\"dur\":%.3f", name, micros(started),
+          micros(now) - micros(started));
+
+  if (arg != 0)
+    fprintf(file, ",\"args\":{\"%s\":%ld}", arg, value);
+
+  fputc('}', file);
+
+  // a full disk ends the trace, what was written still loads
+  if (ferror(file))
+  {
+    fclose(file);
+    file = 0;
+  }
+}
@@ -18,6 +18,8 @@ along with JoeClient; if not, write to the Free Software
 Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
 */
 
+#include <string>
+
 #include <FL/fl_draw.H>
 #include <FL/Fl_Group.H>
 #include <FL/Fl_Double_Window.H>
@@ -47,6 +49,12 @@ void UrlBrowse::add(const char * text)
   url_browse->add(text);
 }
 
+// Fl_Browser keeps its own null-terminated copy
+void UrlBrowse::add(const char *text, const int length)
+{
+  url_browse->add(std::string(text, length).c_str());
+}
+
 void UrlBrowse::bgColor(const Fl_Color c)
 {
   this->color(c);
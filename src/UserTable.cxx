@@ -0,0 +1,220 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "UserTable.H"
+
+namespace
+{
+  // names are packed into chunks this big, longer ones get their own
+  const size_t chunk_size = 16384;
+
+  // rough heap cost of one node in a node based container
+  template <typename T>
+  size_t node_bytes(const T &table)
+  {
+    return table.size() * (sizeof(typename T::value_type) + 2 * sizeof(void *)) +
+           table.bucket_count() * sizeof(void *);
+  }
+}
+
+UserTable::UserTable()
+{
+  chunk_next = 0;
+  chunk_left = 0;
+  pool_size = 0;
+}
+
+UserTable::~UserTable()
+{
+}
+
+// 0 if there is no user on that line
+UserTable::User *UserTable::find(const int line)
+{
+  const iterator it = users.find(line);
+
+  return it == users.end() ? 0 : &it->second;
+}
+
+// line of the active user with that name, -1 if nobody has it, the
+// most recent line to take a name wins
+int UserTable::findName(const char *name)
+{
+  const auto it = by_name.find(name);
+
+  return it == by_name.end() ? -1 : it->second;
+}
+
+UserTable::User *UserTable::add(const int line)
+{
+  return &users[line];
+}
+
+void UserTable::erase(const int line)
+{
+  deactivate(line);
+  users.erase(line);
+}
+
+void UserTable::setName(const int line, const char *name)
+{
+  User *user = add(line);
+
+  deactivate(line);
+  user->name = intern(name);
+  user->active = true;
+  by_name[user->name] = line;
+}
+
+void UserTable::deactivate(const int line)
+{
+  User *user = find(line);
+
+  if (user == 0 || user->active == false)
+    return;
+
+  const auto it = by_name.find(user->name);
+
+  if (it != by_name.end() && it->second == line)
+    by_name.erase(it);
+
+  user->active = false;
+}
+
+void UserTable::clear()
+{
+  users.clear();
+  names.clear();
+  by_name.clear();
+  chunks.clear();
+  chunk_next = 0;
+  chunk_left = 0;
+  pool_size = 0;
+}
+
+int UserTable::size()
+{
+  return users.size();
+}
+
+// approximate heap use of the table and its name pool
+size_t UserTable::memoryUsed()
+{
+  return node_bytes(users) + node_bytes(names) + node_bytes(by_name) +
+         chunks.capacity() * sizeof(chunks[0]) + pool_size;
+}
+
+UserTable::iterator UserTable::begin()
+{
+  return users.begin();
+}
+
+UserTable::iterator UserTable::end()
+{
+  return users.end();
+}
+
+// return the pooled copy of name, adding it the first time it is seen
+const char *UserTable::intern(const char *name)
+{
+  const auto it = names.find(name);
+
+  if (it != names.end())
+    return it->data();
+
+  const size_t length = strlen(name) + 1;
+
+  // names of users who left stay in the pool, rather than grow it
+  // further the live ones are packed into fresh chunks once they take
+  // up less than half
+  if (length > chunk_left && liveBytes() * 2 < pool_size)
+    compact();
+
+  return store(name, length);
+}
+
+// copy length bytes of name into the pool
+const char *UserTable::store(const char *name, const size_t length)
+{
+  if (length > chunk_left)
+  {
+    const size_t size = length > chunk_size ? length : chunk_size;
+
+    chunks.emplace_back(new char[size]);
+    chunk_next = chunks.back().get();
+    chunk_left = size;
+    pool_size += size;
+  }
+
+  char *copy = chunk_next;
+
+  memcpy(copy, name, length);
+  chunk_next += length;
+  chunk_left -= length;
+  names.insert(std::string_view(copy, length - 1));
+
+  return copy;
+}
+
+// pool bytes the table's users point to, a name shared by two users
+// is counted twice
+size_t UserTable::liveBytes()
+{
+  size_t bytes = 0;
+
+  for (const auto &entry : users)
+    bytes += strlen(entry.second.name) + 1;
+
+  return bytes;
+}
+
+// move every user's name to new chunks, dropping the old ones, the
+// name index points into the pool so it is rebuilt as well
+void UserTable::compact()
+{
+  std::vector<std::unique_ptr<char[]>> old;
+  std::unordered_map<std::string_view, int> lines;
+
+  lines.swap(by_name);
+  old.swap(chunks);
+  names.clear();
+  chunk_next = 0;
+  chunk_left = 0;
+  pool_size = 0;
+
+  for (auto &entry : users)
+  {
+    const char *name = entry.second.name;
+    const auto it = names.find(name);
+
+    entry.second.name = it != names.end() ? it->data() :
+                        store(name, strlen(name) + 1);
+  }
+
+  for (const auto &entry : lines)
+    by_name[find(entry.second)->name] = entry.second;
+}
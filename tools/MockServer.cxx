@@ -0,0 +1,795 @@
+/*
+Copyright (c) 2026 Joe Davisson.
+
+This file is part of JoeClient.
+
+JoeClient is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+JoeClient is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JoeClient; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+// stand-in Naken Chat server for load testing the client, linux only
+//
+// simulated users chat, send links and private messages at a steady
+// rate with optional bursts, and netsplits drop a share of them and
+// bring them back; real clients get a nick, can talk and can ask for
+// the user list with .Z
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+namespace
+{
+  const char *usage =
+    "usage: mockserver [options]\n"
+    "\n"
+    "  --port N            plain port (default 6666, 0 for none)\n"
+    "  --tls-port N        TLS port (default none)\n"
+    "  --cert-out FILE     where the self-signed certificate is written\n"
+    "                      (default mockserver.pem), copy it to\n"
+    "                      ~/.joeclient_cacert.pem and connect to\n"
+    "                      localhost\n"
+    "  --users N           simulated users (default 2000)\n"
+    "  --rate N            lines per second from them (default 20)\n"
+    "  --burst N           extra lines sent all at once ...\n"
+    "  --burst-every S     ... every S seconds (default 10)\n"
+    "  --links F           share of lines with a link (default 0.1)\n"
+    "  --pms F             share of lines sent as private messages to\n"
+    "                      one client (default 0.02)\n"
+    "  --split-every S     netsplit every S seconds (default never)\n"
+    "  --split-share F     share of users that leave (default 0.5)\n"
+    "  --split-heal S      seconds until they come back (default 5)\n";
+
+  // a client that stops reading loses its connection once this much
+  // is waiting for it
+  const size_t max_queued = 16 << 20;
+
+  const double tick = 0.01;
+  const double report_interval = 5;
+
+  int port = 6666;
+  int tls_port = 0;
+  const char *cert_out = "mockserver.pem";
+  int user_count = 2000;
+  double rate = 20;
+  int burst = 0;
+  double burst_every = 10;
+  double link_share = 0.1;
+  double pm_share = 0.02;
+  double split_every = 0;
+  double split_share = 0.5;
+  double split_heal = 5;
+
+  struct client
+  {
+    int fd;
+    SSL *ssl;
+    bool handshaking;
+
+    // OpenSSL is waiting for the socket to take more
+    bool want_write;
+
+    bool closing;
+    int id;
+    std::string nick;
+    std::string in;
+    std::string out;
+    size_t out_sent;
+  };
+
+  std::vector<client *> clients;
+
+  // simulated users by id, id 0 isn't used
+  std::vector<bool> present;
+
+  // users gone in the last netsplit
+  std::vector<int> split_users;
+
+  // real clients are numbered after the simulated users
+  int next_id = 0;
+
+  SSL_CTX *ctx = 0;
+
+  std::minstd_rand random_source(std::random_device{}());
+
+  // for the report
+  unsigned long lines_sent = 0;
+  unsigned long bytes_sent = 0;
+  unsigned long dropped = 0;
+
+  const char *words[] =
+  {
+    "the", "server", "is", "slow", "again", "anyone", "seen", "this",
+    "lol", "brb", "ok", "what", "about", "tonight", "patch", "works",
+    "for", "me", "no", "idea", "why", "it", "broke", "restart", "it"
+  };
+
+  const int word_count = sizeof(words) / sizeof(words[0]);
+
+  double uniform()
+  {
+    return std::uniform_real_distribution<double>(0, 1)(random_source);
+  }
+
+  int pick(const int count)
+  {
+    return std::uniform_int_distribution<int>(0, count - 1)(random_source);
+  }
+
+  bool set_non_blocking(const int fd)
+  {
+    return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != -1;
+  }
+
+  int listen_on(const int listen_port)
+  {
+    const int fd = socket(AF_INET6, SOCK_STREAM, 0);
+    const int on = 1;
+    const int off = 0;
+    struct sockaddr_in6 addr;
+
+    if (fd < 0)
+      return -1;
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(listen_port);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(fd, 128) != 0 || set_non_blocking(fd) == false)
+    {
+      close(fd);
+      return -1;
+    }
+
+    return fd;
+  }
+
+  // P-256 key and a certificate for localhost, good for a month
+  bool make_context()
+  {
+    EVP_PKEY *key = 0;
+    EVP_PKEY_CTX *key_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, 0);
+
+    if (key_ctx == 0 || EVP_PKEY_keygen_init(key_ctx) <= 0 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_ctx,
+          NID_X9_62_prime256v1) <= 0 ||
+        EVP_PKEY_keygen(key_ctx, &key) <= 0)
+    {
+      EVP_PKEY_CTX_free(key_ctx);
+      return false;
+    }
+
+    EVP_PKEY_CTX_free(key_ctx);
+
+    X509 *cert = X509_new();
+    X509_NAME *name = X509_get_subject_name(cert);
+    X509V3_CTX v3;
+
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), time(0));
+    X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 30L * 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               (const unsigned char *)"localhost", -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+
+    X509V3_set_ctx_nodb(&v3);
+    X509V3_set_ctx(&v3, cert, cert, 0, 0, 0);
+
+    const char *extensions[][2] =
+    {
+      { "basicConstraints", "critical,CA:TRUE" },
+      { "subjectAltName", "DNS:localhost,IP:127.0.0.1,IP:::1" }
+    };
+
+    for (int i = 0; i < 2; i++)
+    {
+      X509_EXTENSION *ext = X509V3_EXT_conf(0, &v3,
+                                            extensions[i][0],
+                                            extensions[i][1]);
+
+      X509_add_ext(cert, ext, -1);
+      X509_EXTENSION_free(ext);
+    }
+
+    X509_sign(cert, key, EVP_sha256());
+
+    FILE *pem = fopen(cert_out, "w");
+
+    if (pem != 0)
+    {
+      PEM_write_X509(pem, cert);
+      fclose(pem);
+    }
+
+    ctx = SSL_CTX_new(TLS_server_method());
+
+    const bool ok = ctx != 0 && pem != 0 &&
+                    SSL_CTX_use_certificate(ctx, cert) == 1 &&
+                    SSL_CTX_use_PrivateKey(ctx, key) == 1;
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+
+    if (ok == true)
+    {
+      SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE |
+                            SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    }
+
+    return ok;
+  }
+
+  void queue(client *c, const std::string &line)
+  {
+    if (c->closing == true || c->handshaking == true)
+      return;
+
+    c->out += line;
+    c->out += "\r\n";
+    lines_sent++;
+
+    if (c->out.size() - c->out_sent > max_queued)
+    {
+      c->closing = true;
+      dropped++;
+    }
+  }
+
+  void broadcast(const std::string &line)
+  {
+    for (client *c : clients)
+      queue(c, line);
+  }
+
+  std::string user_name(const int id)
+  {
+    return "user" + std::to_string(id);
+  }
+
+  std::string sentence()
+  {
+    std::string text;
+    const int count = 2 + pick(12);
+
+    for (int i = 0; i < count; i++)
+    {
+      if (i > 0)
+        text += ' ';
+
+      text += words[pick(word_count)];
+    }
+
+    return text;
+  }
+
+  // one line from a random simulated user who is around
+  void chatter()
+  {
+    if (user_count == 0)
+      return;
+
+    const int id = 1 + pick(user_count);
+
+    if (present[id] == false)
+      return;
+
+    const double kind = uniform();
+
+    if (kind < pm_share && clients.empty() == false)
+    {
+      queue(clients[pick(clients.size())],
+            "<" + user_name(id) + ": " + sentence());
+    }
+    else if (kind < pm_share + link_share)
+    {
+      broadcast("[" + user_name(id) + "]: " + sentence() +
+                " https://example.com/" + std::to_string(pick(1000000)));
+    }
+      else
+    {
+      broadcast("[" + user_name(id) + "]: " + sentence());
+    }
+  }
+
+  void netsplit()
+  {
+    for (int id = 1; id <= user_count; id++)
+    {
+      if (present[id] == true && uniform() < split_share)
+      {
+        present[id] = false;
+        split_users.push_back(id);
+        broadcast("-[" + std::to_string(id) + "]");
+      }
+    }
+  }
+
+  void heal()
+  {
+    for (int id : split_users)
+    {
+      present[id] = true;
+      broadcast("+[" + std::to_string(id) + "]" + user_name(id));
+    }
+
+    split_users.clear();
+  }
+
+  // everyone around, then the @ line the client waits for
+  void list_users(client *c)
+  {
+    int count = 0;
+
+    for (int id = 1; id <= user_count; id++)
+    {
+      if (present[id] == true)
+      {
+        queue(c, "+[" + std::to_string(id) + "]" + user_name(id));
+        count++;
+      }
+    }
+
+    for (client *other : clients)
+    {
+      if (other->handshaking == false)
+      {
+        queue(c, "+[" + std::to_string(other->id) + "]" + other->nick);
+        count++;
+      }
+    }
+
+    queue(c, "@ " + std::to_string(count) + " users");
+  }
+
+  void handle_line(client *c, std::string line)
+  {
+    if (line.empty() == false && line[line.size() - 1] == '\r')
+      line.erase(line.size() - 1);
+
+    if (line.empty() == true)
+      return;
+
+    if (line == ".Z")
+    {
+      list_users(c);
+    }
+    else if (line.compare(0, 3, ".n ") == 0 && line.size() > 3)
+    {
+      c->nick = line.substr(3);
+      broadcast("+[" + std::to_string(c->id) + "]" + c->nick);
+    }
+    else if (line[0] == '.')
+    {
+      queue(c, ">> unknown command");
+    }
+    else if (line[0] == '%')
+    {
+      broadcast("(" + c->nick + line.substr(1) + ")");
+    }
+      else
+    {
+      broadcast("[" + c->nick + "]: " + line);
+    }
+  }
+
+  void welcome(client *c)
+  {
+    queue(c, ">> Welcome to the mock Naken Chat server, " +
+             std::to_string(user_count) + " simulated users.");
+    broadcast("+[" + std::to_string(c->id) + "]" + c->nick);
+  }
+
+  void accept_clients(const int listen_fd, const bool tls)
+  {
+    int fd;
+
+    while ((fd = accept(listen_fd, 0, 0)) >= 0)
+    {
+      const int on = 1;
+      client *c = new client;
+
+      set_non_blocking(fd);
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+      c->fd = fd;
+      c->ssl = 0;
+      c->handshaking = false;
+      c->want_write = false;
+      c->closing = false;
+      c->id = next_id++;
+      c->nick = "guest" + std::to_string(c->id);
+      c->out_sent = 0;
+
+      clients.push_back(c);
+
+      if (tls == true)
+      {
+        c->ssl = SSL_new(ctx);
+        SSL_set_fd(c->ssl, fd);
+        SSL_set_accept_state(c->ssl);
+        c->handshaking = true;
+      }
+        else
+      {
+        welcome(c);
+      }
+    }
+  }
+
+  void handshake(client *c)
+  {
+    const int result = SSL_do_handshake(c->ssl);
+
+    if (result == 1)
+    {
+      c->handshaking = false;
+      c->want_write = false;
+      welcome(c);
+      return;
+    }
+
+    const int error = SSL_get_error(c->ssl, result);
+
+    if (error == SSL_ERROR_WANT_READ)
+      c->want_write = false;
+    else if (error == SSL_ERROR_WANT_WRITE)
+      c->want_write = true;
+    else
+      c->closing = true;
+  }
+
+  void read_client(client *c)
+  {
+    char buf[16384];
+
+    while (c->closing == false)
+    {
+      int size;
+
+      if (c->ssl)
+      {
+        size = SSL_read(c->ssl, buf, sizeof(buf));
+
+        if (size <= 0)
+        {
+          const int error = SSL_get_error(c->ssl, size);
+
+          if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE)
+            c->closing = true;
+
+          break;
+        }
+      }
+        else
+      {
+        size = read(c->fd, buf, sizeof(buf));
+
+        if (size <= 0)
+        {
+          if (size == 0 || (errno != EAGAIN && errno != EINTR))
+            c->closing = true;
+
+          break;
+        }
+      }
+
+      c->in.append(buf, size);
+    }
+
+    size_t start = 0;
+    size_t end;
+
+    while ((end = c->in.find('\n', start)) != std::string::npos)
+    {
+      handle_line(c, c->in.substr(start, end - start));
+      start = end + 1;
+    }
+
+    c->in.erase(0, start);
+  }
+
+  void write_client(client *c)
+  {
+    while (c->out_sent < c->out.size())
+    {
+      const char *data = c->out.data() + c->out_sent;
+      const int size = c->out.size() - c->out_sent;
+      int sent;
+
+      if (c->ssl)
+      {
+        sent = SSL_write(c->ssl, data, size);
+
+        if (sent <= 0)
+        {
+          const int error = SSL_get_error(c->ssl, sent);
+
+          if (error == SSL_ERROR_WANT_WRITE)
+            c->want_write = true;
+          else if (error != SSL_ERROR_WANT_READ)
+            c->closing = true;
+
+          break;
+        }
+      }
+        else
+      {
+        sent = write(c->fd, data, size);
+
+        if (sent <= 0)
+        {
+          if (errno != EAGAIN && errno != EINTR)
+            c->closing = true;
+
+          break;
+        }
+      }
+
+      c->out_sent += sent;
+      bytes_sent += sent;
+    }
+
+    if (c->out_sent == c->out.size())
+    {
+      c->out.clear();
+      c->out_sent = 0;
+      c->want_write = false;
+    }
+    else if (c->out_sent > (1 << 20))
+    {
+      c->out.erase(0, c->out_sent);
+      c->out_sent = 0;
+    }
+  }
+
+  void drop_closed()
+  {
+    for (size_t i = 0; i < clients.size(); )
+    {
+      client *c = clients[i];
+
+      if (c->closing == false)
+      {
+        i++;
+        continue;
+      }
+
+      if (c->ssl)
+        SSL_free(c->ssl);
+
+      close(c->fd);
+      clients.erase(clients.begin() + i);
+
+      if (c->handshaking == false)
+        broadcast("-[" + std::to_string(c->id) + "]");
+
+      delete c;
+    }
+  }
+
+  bool parse_options(int argc, char **argv)
+  {
+    for (int i = 1; i < argc; i++)
+    {
+      if (i + 1 >= argc)
+        return false;
+
+      const char *name = argv[i];
+      const char *value = argv[++i];
+
+      if (strcmp(name, "--port") == 0)
+        port = atoi(value);
+      else if (strcmp(name, "--tls-port") == 0)
+        tls_port = atoi(value);
+      else if (strcmp(name, "--cert-out") == 0)
+        cert_out = value;
+      else if (strcmp(name, "--users") == 0)
+        user_count = atoi(value);
+      else if (strcmp(name, "--rate") == 0)
+        rate = atof(value);
+      else if (strcmp(name, "--burst") == 0)
+        burst = atoi(value);
+      else if (strcmp(name, "--burst-every") == 0)
+        burst_every = atof(value);
+      else if (strcmp(name, "--links") == 0)
+        link_share = atof(value);
+      else if (strcmp(name, "--pms") == 0)
+        pm_share = atof(value);
+      else if (strcmp(name, "--split-every") == 0)
+        split_every = atof(value);
+      else if (strcmp(name, "--split-share") == 0)
+        split_share = atof(value);
+      else if (strcmp(name, "--split-heal") == 0)
+        split_heal = atof(value);
+      else
+        return false;
+    }
+
+    return user_count >= 0 && rate >= 0 && burst >= 0 &&
+           burst_every > 0 && (port > 0 || tls_port > 0);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (parse_options(argc, argv) == false)
+  {
+    fputs(usage, stderr);
+    return 2;
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+
+  const int plain_fd = port > 0 ? listen_on(port) : -1;
+  const int tls_fd = tls_port > 0 ? listen_on(tls_port) : -1;
+
+  if ((port > 0 && plain_fd < 0) || (tls_port > 0 && tls_fd < 0))
+  {
+    perror("listen");
+    return 1;
+  }
+
+  if (tls_port > 0)
+  {
+    if (make_context() == false)
+    {
+      fprintf(stderr, "can't set up TLS or write %s\n", cert_out);
+      ERR_print_errors_fp(stderr);
+      return 1;
+    }
+
+    fprintf(stderr, "certificate written to %s\n", cert_out);
+  }
+
+  present.assign(user_count + 1, true);
+  next_id = user_count + 1;
+
+  typedef std::chrono::steady_clock clock;
+
+  const clock::time_point start = clock::now();
+  clock::time_point last = start;
+  double due = 0;
+  double next_burst = burst_every;
+  double next_split = split_every;
+  double next_heal = 0;
+  double next_report = report_interval;
+  unsigned long reported_lines = 0;
+  unsigned long reported_bytes = 0;
+
+  std::vector<struct pollfd> fds;
+
+  while (true)
+  {
+    fds.clear();
+    fds.push_back({ plain_fd, POLLIN, 0 });
+    fds.push_back({ tls_fd, POLLIN, 0 });
+
+    for (client *c : clients)
+    {
+      short events = POLLIN;
+
+      if (c->want_write == true ||
+          (c->handshaking == false && c->out_sent < c->out.size()))
+      {
+        events |= POLLOUT;
+      }
+
+      fds.push_back({ c->fd, events, 0 });
+    }
+
+    poll(fds.data(), fds.size(), tick * 1000);
+
+    // clients accepted below aren't in fds yet
+    const size_t polled = clients.size();
+
+    for (size_t i = 0; i < polled; i++)
+    {
+      client *c = clients[i];
+
+      if (fds[i + 2].revents == 0)
+        continue;
+
+      if (c->handshaking == true)
+        handshake(c);
+      else
+        read_client(c);
+    }
+
+    if (fds[0].revents & POLLIN)
+      accept_clients(plain_fd, false);
+
+    if (fds[1].revents & POLLIN)
+      accept_clients(tls_fd, true);
+
+    const clock::time_point now = clock::now();
+    const double elapsed = std::chrono::duration<double>(now - start).count();
+
+    due += std::chrono::duration<double>(now - last).count() * rate;
+    last = now;
+
+    while (due >= 1)
+    {
+      chatter();
+      due--;
+    }
+
+    if (burst > 0 && elapsed >= next_burst)
+    {
+      for (int i = 0; i < burst; i++)
+        chatter();
+
+      next_burst += burst_every;
+    }
+
+    if (split_every > 0 && elapsed >= next_split && split_users.empty())
+    {
+      netsplit();
+      next_heal = elapsed + split_heal;
+      next_split += split_every;
+    }
+
+    if (split_users.empty() == false && elapsed >= next_heal)
+      heal();
+
+    for (client *c : clients)
+    {
+      if (c->handshaking == false)
+        write_client(c);
+    }
+
+    drop_closed();
+
+    if (elapsed >= next_report)
+    {
+      fprintf(stderr, "%d clients, %.0f lines/s, %.1f KB/s, %lu dropped\n",
+              (int)clients.size(),
+              (lines_sent - reported_lines) / report_interval,
+              (bytes_sent - reported_bytes) / report_interval / 1000,
+              dropped);
+
+      reported_lines = lines_sent;
+      reported_bytes = bytes_sent;
+      next_report += report_interval;
+    }
+  }
+
+  return 0;
+}